@@ -0,0 +1,8 @@
+/**************************************************************/
+/* Automatically generated by './mkconfig.sh'.  Do note edit! */
+/**************************************************************/
+#define YALS_OS "Linux vm 6.18.44-fc-v130 x86_64"
+#define YALS_COMPILED "Fri Oct 16 19:28:30 UTC 2026"
+#define YALS_RELEASED "Mon Mar 29 04:24:00 PM EDT 2021"
+#define YALS_VERSION "03v"
+#define YALS_ID "771ace0e3f9a93df23331309be6e632b5cc2d298"
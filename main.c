@@ -2,6 +2,10 @@
 /* Copyright 2021 xnfSAT Authors                                           */
 /*-------------------------------------------------------------------------*/
 
+#ifdef PALSAT
+#define _GNU_SOURCE		// For 'pthread_attr_setaffinity_np'.
+#endif
+
 #include "yals.h"
 
 /*------------------------------------------------------------------------*/
@@ -16,9 +20,11 @@
 #include <limits.h>
 #include <signal.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -26,31 +32,42 @@
 
 /*------------------------------------------------------------------------*/
 #ifdef PALSAT
+#include <dirent.h>
+#include <linux/mempolicy.h>
 #include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
 #include <sys/time.h>
 #endif
 /*------------------------------------------------------------------------*/
 
 #ifdef PALSAT
 #define THREADS 12
-typedef struct Worker { Yals * yals; pthread_t thread; } Worker;
+typedef struct Worker {
+  Yals * yals; pthread_t thread; int cpu, node, config;
+} Worker;
+typedef struct Cpu { int id, package, core, node, rank, pos; } Cpu;
 static Worker * worker;
-static int done, winner, threads = THREADS, threadset;
-struct { pthread_mutex_t done, msg, mem; } lock;
+static atomic_int done;
+static int winner, threads = THREADS, threadset;
+static int pin = 1;	// 0=none, 1=compact, 2=scatter (see '--pin')
+struct { pthread_mutex_t msg, batch; } lock;
 static int waitall = 0;
 #else
 static Yals * yals;
-static int flipsset, memsset;
-static long long flips = -1, mems = -1;
+static int memsset;
+static long long mems = -1;
 #endif
+static int flipsset;
+static long long flips = -1;
 static unsigned long long seed;
+static const char * cachefile;
+static int batch;	// 0=none, 1=list, 2=stream (see '--batch')
 static int seedset, closefile, verbose;
 static const char * filename;
 static FILE * file;
 static int V, C;
 
-struct { size_t allocated, max; } mem;
-
 /*------------------------------------------------------------------------*/
 #ifndef NDEBUG
 static int logging, checking;
@@ -71,24 +88,6 @@ static double average (double a, double b) { return b ? a/b : 0; }
 
 /*------------------------------------------------------------------------*/
 
-#ifdef PALSAT
-#define LOCK(MUTEX) \
-do { \
-  if (pthread_mutex_lock (&lock.MUTEX)) \
-    msg ("failed to lock '%s' mutex in '%s'", #MUTEX, __FUNCTION__); \
-} while (0)
-#define UNLOCK(MUTEX) \
-do { \
-  if (pthread_mutex_unlock (&lock.MUTEX)) \
-    msg ("failed to unlock '%s' mutex in '%s'", #MUTEX, __FUNCTION__); \
-} while (0)
-#else
-#define LOCK(MUTEX) do { } while (0)
-#define UNLOCK(MUTEX) do { } while (0)
-#endif
-
-/*------------------------------------------------------------------------*/
-
 static void die (const char * fmt, ...) {
   va_list ap;
 #ifdef PALSAT
@@ -164,37 +163,123 @@ static double getime () { return yals_process_time (); }
 #endif
 /*------------------------------------------------------------------------*/
 
+// Allocated bytes are counted per thread in separate cache lines and only
+// summed up on demand.  Memory freed by another thread than the one which
+// allocated it makes single counters negative, thus a single counter says
+// nothing about the total.  Since every allocation might increase the
+// total, the sum is recomputed on each of them, which is cheap compared
+// to the allocation itself, and the overall maximum updated.
+
+#define SLOTS 64
+
+typedef struct Slot {
+  atomic_llong allocated;
+  char padding[64 - sizeof (atomic_llong)];
+} Slot;
+
+static Slot slots[SLOTS];
+static _Thread_local Slot * slot = slots;
+static atomic_llong maxallocated;
+
+static long long allocated () {
+  long long res = 0;
+  int i;
+  for (i = 0; i < SLOTS; i++)
+    res += atomic_load_explicit (&slots[i].allocated, memory_order_relaxed);
+  return res;
+}
+
 #define INC(BYTES) \
 do { \
-  LOCK (mem); \
-  mem.allocated += (BYTES); \
-  if (mem.allocated > mem.max) mem.max = mem.allocated; \
-  UNLOCK (mem); \
+  long long CUR, MAX; \
+  atomic_fetch_add_explicit (&slot->allocated, (BYTES), \
+                             memory_order_relaxed); \
+  CUR = allocated (); \
+  MAX = atomic_load_explicit (&maxallocated, memory_order_relaxed); \
+  while (MAX < CUR && \
+         !atomic_compare_exchange_weak (&maxallocated, &MAX, CUR)) \
+    ; \
 } while (0)
 
 #define DEC(BYTES) \
 do { \
-  LOCK (mem); \
-  assert (mem.allocated >= (BYTES)); \
-  mem.allocated -= (BYTES); \
-  UNLOCK (mem); \
+  atomic_fetch_sub_explicit (&slot->allocated, (BYTES), \
+                             memory_order_relaxed); \
 } while (0)
 
-static void * mymalloc (void * dummy, size_t bytes) {
-  void * res = malloc (bytes);
+#ifdef PALSAT
+
+// Large blocks of workers pinned to a processor (see '--pin') are mapped
+// directly and bound to the NUMA node of that processor.  The memory
+// manager state of solver instances is their worker.  Everything else is
+// allocated with 'malloc' as usual.
+
+#define NODEBYTES (1<<16)
+
+static int nodelocal (void * state, size_t bytes) {
+  Worker * w = state;
+  return w && w->node >= 0 && bytes >= NODEBYTES;
+}
+
+static void * nodealloc (void * state, size_t bytes) {
+  Worker * w = state;
+  unsigned long mask;
+  void * res = mmap (0, bytes, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (res == MAP_FAILED) die ("out of memory during 'mmap'");
+  if (w->node < 8 * (int) sizeof mask) {
+    mask = 1ul << w->node;
+    (void) syscall (SYS_mbind, res, bytes, MPOL_PREFERRED,
+                    &mask, 8 * sizeof mask, 0);
+  }
+  return res;
+}
+
+#endif
+
+static void * mymalloc (void * state, size_t bytes) {
+  void * res;
+#ifdef PALSAT
+  if (nodelocal (state, bytes)) res = nodealloc (state, bytes);
+  else res = malloc (bytes);
+#else
+  res = malloc (bytes);
+  (void) state;
+#endif
   if (!res) die ("out of memory during 'malloc'");
-  (void) dummy;
   INC (bytes);
   return res;
 }
 
-static void myfree (void * dummy, void * ptr, size_t bytes) {
+static void myfree (void * state, void * ptr, size_t bytes) {
   DEC (bytes);
+#ifdef PALSAT
+  if (nodelocal (state, bytes)) { munmap (ptr, bytes); return; }
+#else
+  (void) state;
+#endif
   free (ptr);
 }
 
-static void * myrealloc (void * dummy, void * ptr, size_t o, size_t n) {
+static void * myrealloc (void * state, void * ptr, size_t o, size_t n) {
   void * res;
+#ifdef PALSAT
+  if (nodelocal (state, o) && nodelocal (state, n)) {
+    res = mremap (ptr, o, n, MREMAP_MAYMOVE);
+    if (res == MAP_FAILED) die ("out of memory during 'mremap'");
+    DEC (o);
+    INC (n);
+    return res;
+  }
+  if (nodelocal (state, o) || nodelocal (state, n)) {
+    res = mymalloc (state, n);
+    memcpy (res, ptr, o < n ? o : n);
+    myfree (state, ptr, o);
+    return res;
+  }
+#else
+  (void) state;
+#endif
   DEC (o);
   res = realloc (ptr, n);
   if (!res) die ("out of memory during 'realloc'");
@@ -210,17 +295,25 @@ static int hasuffix (const char * arg, const char * suffix) {
   return 1;
 }
 
-static int cmd (const char * arg, const char * suffix, const char * fmt) {
-  struct stat buf;
+static FILE * popenif (const char * arg,
+                       const char * suffix, const char * fmt) {
+  FILE * res;
   char * cmd;
   int len;
   if (!hasuffix (arg, suffix)) return 0;
-  if (stat (arg, &buf)) die ("can not stat file '%s'", arg);
   len = strlen (fmt) + strlen (arg) + 1;
-  cmd = mymalloc (YALS, len);
+  cmd = mymalloc (0, len);
   sprintf (cmd, fmt, arg);
-  file = popen (cmd, "r");
-  myfree (YALS, cmd, len);
+  res = popen (cmd, "r");
+  myfree (0, cmd, len);
+  return res;
+}
+
+static int cmd (const char * arg, const char * suffix, const char * fmt) {
+  struct stat buf;
+  if (!hasuffix (arg, suffix)) return 0;
+  if (stat (arg, &buf)) die ("can not stat file '%s'", arg);
+  file = popenif (arg, suffix, fmt);
   closefile = 2;
   filename= arg;
   return 1;
@@ -285,7 +378,7 @@ static void stats () {
   if (verbose) yals_stats (yals);
   msg ("total process time of %.2f seconds", getime ());
 #endif
-  msg ("maximally allocated %.1f MB", mem.max/(double)(1<<20));
+  msg ("maximally allocated %.1f MB", maxallocated/(double)(1<<20));
 }
 
 static void (*sig_int_handler)(int);
@@ -314,7 +407,7 @@ static void catchsig (int sig) {
     fflush (stdout);
     catchedsig = 1;
     caughtsigmsg (sig);
-    stats ();
+    if (!batch) stats ();
     caughtsigmsg (sig);
   }
   resetsighandlers ();
@@ -344,6 +437,14 @@ static int isfile (const char * p) {
   return !stat (p, &buf);
 }
 
+// Options set on the command line are recorded to be replayed on the
+// fresh instances created for each formula in '--batch' mode.
+
+#define MAXRECORDED 256
+
+static struct { char name[32]; int val; } recorded[MAXRECORDED];
+static int nrecorded;
+
 static int setopt (const char * name, int val) {
   int res;
 #ifdef PALSAT
@@ -354,26 +455,38 @@ static int setopt (const char * name, int val) {
 #else
   res = yals_setopt (yals, name, val);
 #endif
+  if (res) {
+    if (nrecorded == MAXRECORDED || strlen (name) >= sizeof recorded->name)
+      die ("can not record option '%s'", name);
+    strcpy (recorded[nrecorded].name, name);
+    recorded[nrecorded++].val = val;
+  }
   return res;
 }
 
-static int opt (const char * arg) {
+// Sets the option on 'y' only or on all instances if 'y' is zero.
+
+static int setoptof (Yals * y, const char * name, int val) {
+  return y ? yals_setopt (y, name, val) : setopt (name, val);
+}
+
+static int opt (Yals * y, const char * arg) {
   int res = 0;
   assert (arg[0] == '-');
   if (arg[1] == '-') {
     if (arg[2] == 'n' && arg[3] == 'o' && arg[4] == '-')
-      res = setopt (arg + 5, 0);
+      res = setoptof (y, arg + 5, 0);
     else {
       int len = strlen (arg);
       char * name = mymalloc (0, len - 1), * val;
       strcpy (name, arg + 2);
       for (val = name; *val && *val != '='; val++)
         ;
-      if (!*val) res = setopt (name, 1);
+      if (!*val) res = setoptof (y, name, 1);
       else if (*val == '=') {
         *val++ = 0;
         if (isnum (val))
-          res = setopt (name, atoi (val));
+          res = setoptof (y, name, atoi (val));
       }
       myfree (0, name, len - 1);
     }
@@ -384,6 +497,127 @@ static int opt (const char * arg) {
 /*------------------------------------------------------------------------*/
 #ifdef PALSAT
 
+// Portfolio of configurations.  Worker 'i' uses configuration 'i %
+// nconfigs' which is applied before the command line options, thus
+// options given explicitly on the command line override it for all
+// workers.  Configurations only differ in search options and not in the
+// clause data base layout, since workers share the formula of worker 0.
+// The first configuration is the default, thus '-t 1' is unaffected.
+
+typedef struct Config { const char * name, * opts; } Config;
+
+static const Config defconfigs[] = {
+  { "default", "" },
+  { "uniform", "--pick=0 --cb=230" },
+  { "bfs", "--pick=1 --restart=50000" },
+  { "dfs", "--pick=2 --no-cached" },
+  { "rbfs", "--pick=3 --cb=300 --xorweight=300" },
+  { "pbfs", "--pick=-1 --restart=200000" },
+  { "flat",
+    "--weight2=100 --weight3=100 --weight4=100 --weight5=100 "
+    "--weight6=100 --weight7=100 --weight8=100 --xorweight=100" },
+  { "steep",
+    "--cb=200 --weight2=300 --weight3=400 --weight4=450 --weight5=500 "
+    "--weight6=550 --weight7=600 --weight8=650 --xorweight=800" },
+  { "greedy", "--cb=400 --restart=20000 --no-cached" },
+  { "patient", "--cb=180 --restart=1000000 --xorweight=700" },
+};
+
+static const Config * configs = defconfigs;
+static int nconfigs = sizeof defconfigs / sizeof *defconfigs;
+static char * portfolio;	// text of configurations read from file
+static size_t szportfolio;	// configurations followed by their text
+
+// One configuration per line as '<name> [<option> ...]' with options in
+// command line syntax.  Empty lines and lines starting with '#' are
+// skipped.  The name 'none' for the file disables the portfolio.  Formula
+// layout options are rejected (see 'layoutopt').
+
+static void readportfolio (const char * path) {
+  Config * c;
+  size_t n;
+  char * p;
+  FILE * f;
+  int ch, i;
+  if (!strcmp (path, "none")) { nconfigs = 1; return; }
+  if (!(f = fopen (path, "r"))) die ("can not read portfolio '%s'", path);
+  szportfolio = 1, n = 0;
+  while ((ch = getc (f)) != EOF) {
+    if (ch == '\n') n++;
+    szportfolio++;
+  }
+  rewind (f);
+  szportfolio += (n + 1) * sizeof *c;
+  portfolio = mymalloc (0, szportfolio);
+  c = (Config *) portfolio;
+  p = portfolio + (n + 1) * sizeof *c;
+  i = 0;
+  while ((ch = getc (f)) != EOF) {
+    if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') continue;
+    if (ch == '#') {
+      while ((ch = getc (f)) != EOF && ch != '\n')
+        ;
+      continue;
+    }
+    assert (i <= (int) n);
+    c[i].name = p;
+    while (ch != EOF && ch != '\n' && ch != ' ' && ch != '\t')
+      *p++ = ch, ch = getc (f);
+    *p++ = 0;
+    while (ch == ' ' || ch == '\t') ch = getc (f);
+    c[i].opts = p;
+    while (ch != EOF && ch != '\n')
+      *p++ = ch, ch = getc (f);
+    while (p > c[i].opts && isspace (p[-1])) p--;
+    *p++ = 0;
+    i++;
+  }
+  fclose (f);
+  if (!i) die ("no configuration in portfolio '%s'", path);
+  configs = c, nconfigs = i;
+}
+
+// Options fixing the layout of the formula.  Workers other than worker 0
+// attach to its formula, thus these would be silently ignored.
+
+static const char * layoutopts[] = {
+  "inlinesmall", "prep", "reorder", "wideoccs", "xmasks", 0
+};
+
+static int layoutopt (const char * arg) {
+  const char ** o;
+  size_t len;
+  if (arg[0] != '-' || arg[1] != '-') return 0;
+  arg += 2;
+  if (!strncmp (arg, "no-", 3)) arg += 3;
+  len = strcspn (arg, "=");
+  for (o = layoutopts; *o; o++)
+    if (strlen (*o) == len && !strncmp (*o, arg, len)) return 1;
+  return 0;
+}
+
+static void configure (int i) {
+  const Config * c = configs + worker[i].config;
+  const char * p = c->opts, * q;
+  char buf[80];
+  while (*p) {
+    while (isspace (*p)) p++;
+    for (q = p; *q && !isspace (*q); q++)
+      ;
+    if (q == p) break;
+    if (q - p >= (int) sizeof buf)
+      die ("option too long in configuration '%s'", c->name);
+    memcpy (buf, p, q - p);
+    buf[q - p] = 0;
+    if (layoutopt (buf))
+      die ("formula layout option '%s' in configuration '%s' "
+        "(give it on the command line instead)", buf, c->name);
+    if (buf[0] != '-' || !opt (worker[i].yals, buf))
+      die ("invalid option '%s' in configuration '%s'", buf, c->name);
+    p = q;
+  }
+}
+
 static void lockmsg (void* dummy) {
   (void) dummy;
   pthread_mutex_lock (&lock.msg);
@@ -397,34 +631,29 @@ static void unlockmsg (void* dummy) {
 /* Attempts to CAS done from 0 to r where r != 0. If suceeded,
 sets winner to w and returns 0. Otherwise, returns -1. */
 static int setdone (int w, int r) {
-  int res;
+  int expected = 0;
   assert(r != 0);
-  LOCK (done);
-  if (r) { winner = w; done = r; }
-  res = winner;
+  if (!atomic_compare_exchange_strong (&done, &expected, r)) return -1;
   winner = w;
-  UNLOCK (done);
-  return res;
+  return 0;
 }
 
 static int workers_should_terminate (void * dummy) {
-  if (waitall) return 0;
-  int res;
   (void) dummy;
-  LOCK (done);
-  res = done;
-  UNLOCK (done);
-  return res;
+  if (waitall) return 0;
+  return atomic_load_explicit (&done, memory_order_relaxed);
 }
 
 static void * run (void * p) {
   Worker * w = p;
   int res, widx = w - worker;
   assert (0 <= widx), assert (widx < threads);
+  slot = slots + 1 + widx % (SLOTS - 1);
   res = yals_sat (w->yals);
   if (res) {
     if (!setdone (widx, res)) {
-      msg ("worker %d wins with result %d", widx, res);
+      msg ("worker %d wins with result %d using configuration '%s'",
+        widx, res, configs[w->config].name);
     } else {
       msg ("worker %d done with result %d", widx, res);
     }
@@ -433,18 +662,33 @@ static void * run (void * p) {
   return p;
 }
 
-static int palsat () {
+static int palsat (void * (*routine) (void *)) {
+  pthread_attr_t attr;
+  cpu_set_t set;
   int i;
-  for (i = 0; i < threads; i++)
-    if (pthread_create (&worker[i].thread, 0, run, worker + i))
+  for (i = 0; i < threads; i++) {
+    if (pthread_attr_init (&attr))
+      die ("failed to initialize attributes of thread %d", i);
+    if (worker[i].cpu >= 0) {
+      CPU_ZERO (&set);
+      CPU_SET (worker[i].cpu, &set);
+      if (pthread_attr_setaffinity_np (&attr, sizeof set, &set))
+        die ("failed to pin thread %d to processor %d", i, worker[i].cpu);
+    }
+    if (pthread_create (&worker[i].thread, &attr, routine, worker + i))
       die ("failed to created thread %d", i);
+    else if (worker[i].cpu >= 0)
+      msg ("created thread %d on processor %d of node %d",
+        i, worker[i].cpu, worker[i].node);
     else msg ("created thread %d", i);
+    pthread_attr_destroy (&attr);
+  }
   for (i = 0; i < threads; i++)
     if (pthread_join (worker[i].thread, 0))
       die ("failed to join thread %d", i);
     else msg ("joined thread %d", i);
   msg ("");
-  return done;
+  return atomic_load (&done);
 
 }
 
@@ -453,15 +697,128 @@ static int palsat () {
 
 #ifdef PALSAT
 static void initlocks () {
-  pthread_mutex_init (&lock.mem, 0);
   pthread_mutex_init (&lock.msg, 0);
-  pthread_mutex_init (&lock.done, 0);
+  pthread_mutex_init (&lock.batch, 0);
+}
+
+// Processor topology as found in '/sys/devices/system' restricted to the
+// processors this process is allowed to run on.  Hyper-threads of the
+// same core get increasing ranks.  For '--pin=scatter' position 'pos' is
+// the index of a processor within its node among those of the same rank.
+
+static Cpu * cpus;
+static int ncpus, szcpus, ncores, nnodes;
+
+static int readsysint (const char * fmt, int n, int * res) {
+  char path[128];
+  FILE * f;
+  int ok;
+  snprintf (path, sizeof path, fmt, n);
+  if (!(f = fopen (path, "r"))) return 0;
+  ok = (fscanf (f, "%d", res) == 1);
+  fclose (f);
+  return ok;
+}
+
+// Reads a list of ranges such as '0-3,8-11' and calls 'fun' on each
+// number.  Returns the number of numbers read.
+
+static int readsyslist (const char * fmt, int n,
+                        void (*fun) (int, int), int arg) {
+  int res = 0, from, to, ch;
+  char path[128];
+  FILE * f;
+  snprintf (path, sizeof path, fmt, n);
+  if (!(f = fopen (path, "r"))) return 0;
+  while (fscanf (f, "%d", &from) == 1) {
+    to = from;
+    if ((ch = getc (f)) == '-') {
+      if (fscanf (f, "%d", &to) != 1) break;
+      ch = getc (f);
+    }
+    while (from <= to) fun (from++, arg), res++;
+    if (ch != ',') break;
+  }
+  fclose (f);
+  return res;
+}
+
+static void addcpu (int id, int arg) {
+  Cpu * c;
+  (void) arg;
+  if (ncpus == szcpus) {
+    int sz = szcpus ? 2*szcpus : 16;
+    cpus = myrealloc (0, cpus, szcpus * sizeof *cpus, sz * sizeof *cpus);
+    szcpus = sz;
+  }
+  c = cpus + ncpus++;
+  c->id = id;
+  if (!readsysint ("/sys/devices/system/cpu/cpu%d/topology/physical_package_id",
+                   id, &c->package)) c->package = 0;
+  if (!readsysint ("/sys/devices/system/cpu/cpu%d/topology/core_id",
+                   id, &c->core)) c->core = id;
+  c->node = 0;
+  c->rank = c->pos = 0;
+}
+
+static void setnode (int id, int node) {
+  int i;
+  for (i = 0; i < ncpus; i++)
+    if (cpus[i].id == id) cpus[i].node = node;
+}
+
+static void addnode (int node, int arg) {
+  (void) arg;
+  readsyslist ("/sys/devices/system/node/node%d/cpulist", node,
+               setnode, node);
+  nnodes++;
+}
+
+static int cmpcompact (const void * p, const void * q) {
+  const Cpu * c = p, * d = q;
+  if (c->rank != d->rank) return c->rank - d->rank;
+  if (c->node != d->node) return c->node - d->node;
+  if (c->package != d->package) return c->package - d->package;
+  if (c->core != d->core) return c->core - d->core;
+  return c->id - d->id;
+}
+
+static int cmpscatter (const void * p, const void * q) {
+  const Cpu * c = p, * d = q;
+  if (c->rank != d->rank) return c->rank - d->rank;
+  if (c->pos != d->pos) return c->pos - d->pos;
+  return cmpcompact (p, q);
+}
+
+static void gettopology () {
+  cpu_set_t allowed;
+  int i, j;
+  if (cpus) return;
+  readsyslist ("/sys/devices/system/cpu/online", 0, addcpu, 0);
+  if (!sched_getaffinity (0, sizeof allowed, &allowed)) {
+    for (i = j = 0; i < ncpus; i++)
+      if (CPU_ISSET (cpus[i].id, &allowed)) cpus[j++] = cpus[i];
+    ncpus = j;
+  }
+  readsyslist ("/sys/devices/system/node/online", 0, addnode, 0);
+  for (i = 0; i < ncpus; i++)
+    for (j = 0; j < i; j++)
+      if (cpus[j].package == cpus[i].package &&
+          cpus[j].core == cpus[i].core &&
+          cpus[j].node == cpus[i].node)
+        cpus[i].rank++;
+  for (i = ncores = 0; i < ncpus; i++)
+    if (!cpus[i].rank) ncores++;
+  qsort (cpus, ncpus, sizeof *cpus, cmpcompact);
+  for (i = 0; i < ncpus; i++)
+    for (j = 0; j < i; j++)
+      if (cpus[j].rank == cpus[i].rank && cpus[j].node == cpus[i].node)
+        cpus[i].pos++;
+  if (pin == 2) qsort (cpus, ncpus, sizeof *cpus, cmpscatter);
 }
 
 static int getsystemcores (int explain) {
-  int syscores, coreids, physids, procpuinfocores;
-  int usesyscores, useprocpuinfo, amd, intel, res;
-  FILE * p;
+  int syscores, res;
 
   syscores = sysconf (_SC_NPROCESSORS_ONLN);
   if (explain) {
@@ -471,85 +828,20 @@ static int getsystemcores (int explain) {
       msg ("'sysconf' fails to determine number of online processors");
   }
 
-  p = popen ("grep '^core id' /proc/cpuinfo 2>/dev/null|sort|uniq|wc -l", "r");
-  if (p) {
-    if (fscanf (p, "%d", &coreids) != 1) coreids = 0;
-    if (explain) {
-      if (coreids > 0)
-        msg ("found %d unique core ids in '/proc/cpuinfo'", coreids);
-      else
-        msg ("failed to extract core ids from '/proc/cpuinfo'");
-    }
-    pclose (p);
-  } else coreids = 0;
-
-  p = popen (
-        "grep '^physical id' /proc/cpuinfo 2>/dev/null|sort|uniq|wc -l", "r");
-  if (p) {
-    if (fscanf (p, "%d", &physids) != 1) physids = 0;
-    if (explain) {
-      if (physids > 0)
-        msg ("found %d unique physical ids in '/proc/cpuinfo'",
-            physids);
-      else
-        msg ("failed to extract physical ids from '/proc/cpuinfo'");
-    }
-    pclose (p);
-  } else physids = 0;
-
-  if (coreids > 0 && physids > 0 &&
-      (procpuinfocores = coreids * physids) > 0) {
-    if (explain)
-      msg ("%d cores = %d core times %d physical ids in '/proc/cpuinfo'",
-           procpuinfocores, coreids, physids);
-  } else procpuinfocores = 0;
-
-  usesyscores = useprocpuinfo = 0;
-
-  if (procpuinfocores > 0 && procpuinfocores == syscores) {
-    if (explain) msg ("'sysconf' and '/proc/cpuinfo' results match");
-    usesyscores = 1;
-  } else if (procpuinfocores > 0 && syscores <= 0) {
-    if (explain) msg ("only '/proc/cpuinfo' result valid");
-    useprocpuinfo = 1;
-  } else if (procpuinfocores <= 0 && syscores > 0) {
-    if (explain) msg ("only 'sysconf' result valid");
-    usesyscores = 1;
-  } else {
-    intel = !system ("grep vendor /proc/cpuinfo 2>/dev/null|grep -q Intel");
-    if (intel && explain)
-      msg ("found Intel as vendor in '/proc/cpuinfo'");
-    amd = !system ("grep vendor /proc/cpuinfo 2>/dev/null|grep -q AMD");
-    if (amd && explain)
-      msg ("found AMD as vendor in '/proc/cpuinfo'");
-    assert (syscores > 0);
-    assert (procpuinfocores > 0);
-    assert (syscores != procpuinfocores);
-    if (amd) {
-      if (explain) msg ("trusting 'sysconf' on AMD");
-      usesyscores = 1;
-    } else if (intel) {
-      if (explain) {
-        msg (
-             "'sysconf' result off by a factor of %f on Intel",
-             syscores / (double) procpuinfocores);
-        msg ("trusting '/proc/cpuinfo' on Intel");
-      }
-      useprocpuinfo = 1;
-    }  else {
-      if (explain)
-        msg ("trusting 'sysconf' on unknown vendor machine");
-      usesyscores = 1;
-    }
+  gettopology ();
+  if (explain) {
+    if (ncores > 0)
+      msg ("found %d cores with %d usable processors on %d nodes in sysfs",
+           ncores, ncpus, nnodes);
+    else
+      msg ("failed to extract processor topology from sysfs");
   }
 
-  if (useprocpuinfo) {
+  if (ncores > 0) {
     if (explain)
-      msg (
-        "assuming cores = core * physical ids in '/proc/cpuinfo' = %d",
-        procpuinfocores);
-    res = procpuinfocores;
-  } else if (usesyscores) {
+      msg ("assuming cores = number of cores found in sysfs = %d", ncores);
+    res = ncores;
+  } else if (syscores > 0) {
     if (explain)
       msg ("assuming cores = number of processors reported by 'sysconf' = %d",
            syscores);
@@ -562,12 +854,495 @@ static int getsystemcores (int explain) {
 
   return res;
 }
+
+// Assigns worker 'i' to the processor 'i' modulo the number of processors
+// in compact or scatter order.  The worker then allocates on its node.
+
+static void placeworker (int i) {
+  Cpu * c;
+  worker[i].cpu = worker[i].node = -1;
+  if (!pin) return;
+  gettopology ();
+  if (!ncpus) return;
+  c = cpus + (i % ncpus);
+  worker[i].cpu = c->id;
+  worker[i].node = c->node;
+}
 #endif
 
+/*------------------------------------------------------------------------*/
+
+// The body of regular files is parsed from a memory mapped copy.  It is
+// split into chunks ending at clause boundaries, which are parsed into
+// literal buffers (concurrently with 'PALSAT') and then added in order
+// with 'yals_add_clauses'.  The 'x' prefix of the i-th clause of a chunk
+// is recorded in 'xors[i]'.
+
+#define MINCHUNK (1<<20)
+
+typedef struct Chunk {
+  const char * start, * end;
+  int * lits, nlits, szlits, complete;
+  unsigned char * xors; int nxors, szxors;
+  int isxor;
+#ifdef PALSAT
+  pthread_t thread;
+#endif
+} Chunk;
+
+static void pushchunk (Chunk * c, int lit) {
+  if (c->nlits == c->szlits) {
+    int szlits = c->szlits ? 2*c->szlits : 1024;
+    c->lits = myrealloc (0, c->lits,
+      c->szlits * sizeof *c->lits, szlits * sizeof *c->lits);
+    c->szlits = szlits;
+  }
+  c->lits[c->nlits++] = lit;
+  if (lit) return;
+  if (c->nxors == c->szxors) {
+    int szxors = c->szxors ? 2*c->szxors : 256;
+    c->xors = myrealloc (0, c->xors, c->szxors, szxors);
+    c->szxors = szxors;
+  }
+  c->xors[c->nxors++] = c->isxor;
+  c->complete = c->nlits;
+  c->isxor = 0;
+}
+
+// Returns the end of the first clause terminated after the first new-line
+// following 'p', which thus can not be within a comment.
+
+static const char * nextclause (const char * p, const char * end) {
+  int zero;
+  while (p < end && *p++ != '\n')
+    ;
+  while (p < end) {
+    if (*p == 'c') {
+      while (p < end && *p != '\n') p++;
+    } else if (*p == '-' || isdigit (*p)) {
+      zero = (*p != '-');
+      if (*p == '-') p++;
+      while (p < end && isdigit (*p))
+        if (*p++ != '0') zero = 0;
+      if (zero) return p;
+    } else p++;
+  }
+  return end;
+}
+
+// Same syntax as 'parseclauses' except for counting clauses.
+
+static void parsechunk (Chunk * c) {
+  const char * p = c->start, * end = c->end;
+  int ch, sign, lit;
+  while (p < end) {
+    ch = *p++;
+    if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') continue;
+    if (ch == 'c') {
+      while (p < end && *p != '\n') p++;
+      if (p == end) perr ("end-of-file in comment");
+      continue;
+    }
+    if (ch == 'x') {
+      if (c->isxor || c->complete < c->nlits)
+        perr ("XOR clause began without ending previous clause");
+      c->isxor = 1;
+      continue;
+    }
+    if (ch == '-') {
+      if (p == end) perr ("expected digit");
+      ch = *p++;
+      if (ch == '0') perr ("expected non-zero digit");
+      sign = -1;
+    } else sign = 1;
+    if (!isdigit (ch)) perr ("expected digit");
+    lit = ch - '0';
+    while (p < end && isdigit (ch = *p)) {
+      lit = 10*lit + (ch - '0');
+      p++;
+    }
+    if (p < end && (ch = *p) != ' ' && ch != '\r' && ch != '\n')
+      perr ("expected space or new-line");
+    if (lit > V) perr ("maximum variable index exceeded");
+    pushchunk (c, sign * lit);
+  }
+}
+
+#ifdef PALSAT
+static void * runparse (void * p) { parsechunk (p); return p; }
+#endif
+
+// Returns zero if 'file' can not be mapped.  Otherwise updates the number
+// of clauses still expected and the last parsed literal.
+
+static int parsemapped (int * n, int * lit) {
+  const char * start, * end, * p;
+  int nchunks, i;
+  struct stat buf;
+  Chunk * chunks;
+  size_t bytes;
+  long offset;
+  void * map;
+  if (fstat (fileno (file), &buf) || !S_ISREG (buf.st_mode)) return 0;
+  if ((offset = ftell (file)) < 0 || buf.st_size <= offset) return 0;
+  bytes = buf.st_size;
+  map = mmap (0, bytes, PROT_READ, MAP_PRIVATE, fileno (file), 0);
+  if (map == MAP_FAILED) return 0;
+  (void) madvise (map, bytes, MADV_SEQUENTIAL);
+  start = (const char *) map + offset, end = (const char *) map + bytes;
+#ifdef PALSAT
+  nchunks = (end - start) / MINCHUNK + 1;
+  if (nchunks > threads) nchunks = threads;
+#else
+  nchunks = 1;
+#endif
+  chunks = mymalloc (0, nchunks * sizeof *chunks);
+  memset (chunks, 0, nchunks * sizeof *chunks);
+  for (i = 0, p = start; i < nchunks; i++) {
+    chunks[i].start = p;
+    if (i + 1 < nchunks)
+      p = nextclause (start + (end - start) * (i + 1) / nchunks, end);
+    else p = end;
+    if (p < chunks[i].start) p = chunks[i].start;
+    chunks[i].end = p;
+  }
+  msg ("parsing memory mapped file in %d chunks", nchunks);
+#ifdef PALSAT
+  for (i = 0; i < nchunks; i++)
+    if (pthread_create (&chunks[i].thread, 0, runparse, chunks + i))
+      die ("failed to create parser thread %d", i);
+  for (i = 0; i < nchunks; i++)
+    if (pthread_join (chunks[i].thread, 0))
+      die ("failed to join parser thread %d", i);
+#else
+  for (i = 0; i < nchunks; i++) parsechunk (chunks + i);
+#endif
+  for (i = 0; i < nchunks; i++) {
+    Chunk * c = chunks + i;
+    if (c->nxors > *n || (c->nxors == *n && c->complete < c->nlits))
+      perr ("too many clauses");
+    *n -= c->nxors;
+    if (c->nlits) *lit = c->lits[c->nlits - 1];
+    yals_add_clauses (YALS, c->lits, c->complete, c->xors);
+    myfree (0, c->lits, c->szlits * sizeof *c->lits);
+    myfree (0, c->xors, c->szxors);
+  }
+  myfree (0, chunks, nchunks * sizeof *chunks);
+  munmap (map, bytes);
+  return 1;
+}
+
+// Cached assignments are read into all instances.  Afterwards those of
+// all instances are written, which bounds and merges them on reading.
+
+static void readcache () {
+  FILE * f;
+  int n = 0;
+  if (!cachefile || !(f = fopen (cachefile, "r"))) return;
+#ifdef PALSAT
+  int i;
+  for (i = 0; i < threads; i++) {
+    rewind (f);
+    n = yals_read_cache (worker[i].yals, f);
+  }
+#else
+  n = yals_read_cache (yals, f);
+#endif
+  fclose (f);
+  msg ("read %d cached assignments from '%s'", n, cachefile);
+}
+
+static void writecache () {
+  FILE * f;
+  int n = 0;
+  if (!cachefile) return;
+  if (!(f = fopen (cachefile, "w")))
+    die ("can not write cache file '%s'", cachefile);
+#ifdef PALSAT
+  int i;
+  for (i = 0; i < threads; i++) n += yals_write_cache (worker[i].yals, f);
+#else
+  n = yals_write_cache (yals, f);
+#endif
+  fclose (f);
+  msg ("wrote %d cached assignments to '%s'", n, cachefile);
+}
+
+// Reentrant parsing of a formula used by 'main' and batch instances.  The
+// header parser returns 1 after reading the header, zero at end-of-file
+// before a header and -1 with an error message otherwise.
+
+static int parseheader (FILE * f, int * maxvar, int * nclauses,
+                        const char ** err) {
+  int ch, m, n;
+  char fmt[4];
+  for (;;) {
+    ch = getc (f);
+    if (ch == EOF) return 0;
+    if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') continue;
+    if (ch != 'c') break;
+    while ((ch = getc (f)) != '\n')
+      if (ch == EOF) { *err = "end-of-file in comment"; return -1; }
+  }
+  if (ch != 'p') { *err = "expected 'p' or 'c'"; return -1; }
+  if (fscanf (f, " %3s %d %d", fmt, &m, &n) != 3 || m < 0 || n < 0 ||
+      (strcmp (fmt, "cnf") && strcmp (fmt, "xnf"))) {
+    *err = "invalid header";
+    return -1;
+  }
+  *maxvar = m, *nclauses = n;
+  return 1;
+}
+
+// Adds the 'n' clauses over 'm' variables following the header to 'y' and
+// returns 1 or -1 with an error message.  With 'whole' anything but
+// comments after the last clause is an error, otherwise parsing stops
+// there.
+
+static int parseclauses (Yals * y, FILE * f, int whole,
+                         int m, int n, const char ** err) {
+  int ch, sign, lit, open = 0;
+  while (n > 0) {
+    ch = getc (f);
+    if (ch == EOF || (ch == 'p' && !whole)) {
+      if (ch == 'p') ungetc (ch, f);
+      *err = n > 1 ? "clauses missing" : "one clause missing";
+      return -1;
+    }
+    if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') continue;
+    if (ch == 'c') {
+      while ((ch = getc (f)) != '\n')
+        if (ch == EOF) { *err = "end-of-file in comment"; return -1; }
+      continue;
+    }
+    if (ch == 'x') {
+      if (open) {
+        *err = "XOR clause began without ending previous clause";
+        return -1;
+      }
+      yals_begin_xor_clause (y);
+      open = 1;
+      continue;
+    }
+    if (ch == '-') {
+      ch = getc (f);
+      if (ch == '0') { *err = "expected non-zero digit"; return -1; }
+      sign = -1;
+    } else sign = 1;
+    if (!isdigit (ch)) { *err = "expected digit"; return -1; }
+    lit = ch - '0';
+    while (isdigit (ch = getc (f)))
+      if ((lit = 10*lit + (ch - '0')) > m) break;
+    if (lit > m) { *err = "maximum variable index exceeded"; return -1; }
+    if (ch != EOF && ch != ' ' && ch != '\r' && ch != '\n') {
+      *err = "expected space or new-line";
+      return -1;
+    }
+    yals_add (y, sign * lit);
+    if (lit) open = 1;
+    else open = 0, n--;
+  }
+  while (whole && (ch = getc (f)) != EOF) {
+    if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') continue;
+    if (ch != 'c') { *err = "too many clauses"; return -1; }
+    while ((ch = getc (f)) != '\n' && ch != EOF)
+      ;
+  }
+  return 1;
+}
+
+// Returns 1 if a formula was added to 'y' and otherwise as 'parseheader'.
+
+static int parseformula (Yals * y, FILE * f, int whole,
+                         int * maxvar, const char ** err) {
+  int res, n;
+  if ((res = parseheader (f, maxvar, &n, err)) <= 0) return res;
+  return parseclauses (y, f, whole, *maxvar, n, err);
+}
+
+/*------------------------------------------------------------------------*/
+
+// In '--batch' mode the input is a list of files with one formula each or
+// with '--batch=stream' a concatenation of formulas.  Each formula is
+// solved by a fresh instance with the recorded command line options.
+// With 'PALSAT' all workers take instances from the shared input, while
+// fresh instances inherit the score tables of the previous instance of
+// the same worker.  Results are printed per instance in one block.
+// Without a flips limit given, instances stop after 'BATCHFLIPS' flips,
+// since a hard or unsatisfiable formula would otherwise block its worker
+// forever.
+
+#define BATCHFLIPS 10000000
+
+static int ninstances;
+static struct { int sat, unsat, unknown, failed; } batched;
+
+static void lockbatch () {
+#ifdef PALSAT
+  pthread_mutex_lock (&lock.batch);
+#endif
+}
+
+static void unlockbatch () {
+#ifdef PALSAT
+  pthread_mutex_unlock (&lock.batch);
+#endif
+}
+
+// Skips to the next line starting with 'p' after a stream parse error.
+
+static void skipformula (FILE * f) {
+  int ch, bol = 1;
+  while ((ch = getc (f)) != EOF) {
+    if (bol && ch == 'p') { ungetc (ch, f); return; }
+    bol = (ch == '\n');
+  }
+}
+
+// Reads the next formula of the stream into 'y' or the next path of the
+// list into 'path'.  Returns the number of the instance or -1 at the end.
+
+static int nextinstance (Yals * y, char * path, int size,
+                         int * maxvar, const char ** err) {
+  int res, len, ch, parsed;
+  lockbatch ();
+  *err = 0;
+  if (batch == 2) {
+    parsed = parseformula (y, file, 0, maxvar, err);
+    if (parsed < 0) skipformula (file);
+    res = parsed ? ninstances++ : -1;
+    if (res >= 0) snprintf (path, size, "%s:%d", filename, res + 1);
+  } else {
+    do {
+      len = 0;
+      while ((ch = getc (file)) != EOF && ch != '\n')
+        if (len + 1 < size) path[len++] = ch;
+      while (len && isspace (path[len-1])) len--;
+      path[len] = 0;
+    } while (!len && ch != EOF);
+    res = len ? ninstances++ : -1;
+  }
+  unlockbatch ();
+  return res;
+}
+
+static int parsefile (Yals * y, const char * path,
+                      int * maxvar, const char ** err) {
+  int res, pipe = 1;
+  FILE * f;
+  if (!(f = popenif (path, ".gz", "gunzip -c %s")) &&
+      !(f = popenif (path, ".bz2", "bunzip -d -c %s")) &&
+      !(f = popenif (path, ".xz", "xz -d -c %s")))
+    f = fopen (path, "r"), pipe = 0;
+  if (!f) { *err = "can not read file"; return -1; }
+  res = parseformula (y, f, 1, maxvar, err);
+  if (!res) *err = "no formula", res = -1;
+  if (pipe) pclose (f);
+  else fclose (f);
+  return res;
+}
+
+static Yals * newinstance (void * state, const char * prefix) {
+  Yals * y = yals_new_with_mem_mgr (state, mymalloc, myrealloc, myfree);
+  int i;
+  for (i = 0; i < nrecorded; i++)
+    yals_setopt (y, recorded[i].name, recorded[i].val);
+  yals_setprefix (y, prefix);
+#ifdef PALSAT
+  yals_setmsglock (y, lockmsg, unlockmsg, 0);
+  yals_setime (y, getime);
+#endif
+  yals_srand (y, seed);
+  yals_setflipslimit (y, flipsset ? flips : BATCHFLIPS);
+#ifndef PALSAT
+  if (memsset) yals_setmemslimit (y, mems);
+#endif
+  return y;
+}
+
+static void printinstance (Yals * y, int k, const char * path,
+                           int res, int maxvar, const char * err) {
+  int i, lit;
+#ifdef PALSAT
+  lockmsg (0);
+#endif
+  fflush (stdout);
+  if (err) {
+    printf ("c instance %d '%s' failed: %s\n", k + 1, path, err);
+    fputs ("s UNKNOWN\n", stdout);
+    batched.failed++;
+  } else {
+    printf (
+      "c instance %d '%s' result %d minimum %d after %lld flips\n",
+      k + 1, path, res, yals_minimum (y), yals_flips (y));
+    if (res == 10) fputs ("s SATISFIABLE\n", stdout), batched.sat++;
+    else if (res == 20) fputs ("s UNSATISFIABLE\n", stdout), batched.unsat++;
+    else fputs ("s UNKNOWN\n", stdout), batched.unknown++;
+    if (res == 10 && yals_getopt (y, "witness")) {
+      for (i = 1; i <= maxvar; i++) {
+        lit = (yals_deref (y, i) > 0) ? i : -i;
+        printval (lit);
+      }
+      printval (0);
+      if (nvaline) printvaline ();
+    }
+  }
+  fflush (stdout);
+#ifdef PALSAT
+  unlockmsg (0);
+#endif
+}
+
+static void * runbatch (void * p) {
+  Yals * y, * prev = 0;
+  char path[4096], prefix[80];
+  int k, res, maxvar;
+  const char * err;
+#ifdef PALSAT
+  Worker * w = p;
+  int widx = w - worker;
+  slot = slots + 1 + widx % (SLOTS - 1);
+  sprintf (prefix, "c %02d ", widx);
+#else
+  strcpy (prefix, "c ");
+#endif
+  for (;;) {
+    y = newinstance (p, prefix);
+    if (prev) yals_inherit_tables (y, prev), yals_del (prev), prev = 0;
+    if ((k = nextinstance (y, path, sizeof path, &maxvar, &err)) < 0) break;
+    if (!err && batch == 1) (void) parsefile (y, path, &maxvar, &err);
+    res = err ? 0 : yals_sat (y);
+    printinstance (y, k, path, res, maxvar, err);
+    prev = y;
+  }
+  yals_del (y);
+  return p;
+}
+
+static int runbatches () {
+  msg ("solving %s of '%s' in batch mode",
+    batch == 2 ? "concatenated formulas" : "files listed", filename);
+  msg ("limiting each instance to %lld flips%s",
+    flipsset ? flips : BATCHFLIPS, flipsset ? "" : " (by default)");
+#ifdef PALSAT
+  palsat (runbatch);
+#else
+  runbatch (0);
+#endif
+  msg ("");
+  msg ("solved %d instances in %.2f seconds: "
+    "%d satisfiable, %d unsatisfiable, %d unknown, %d failed",
+    ninstances, getime (),
+    batched.sat, batched.unsat, batched.unknown, batched.failed);
+  if (ninstances && batched.sat == ninstances) return 10;
+  if (ninstances && batched.unsat == ninstances) return 20;
+  return 0;
+}
+
 static void usage () {
 #ifdef PALSAT
   printf (
-    "usage: palsat [<option> ...] [<file> [<seed>]]\n");
+    "usage: palsat [<option> ...] [<file> [<seed> [<flips>]]]\n");
 #else
   printf (
     "usage: yalsat [<option> ...] [<file> [<seed> [<flips> [<mems>]]]]\n");
@@ -582,10 +1357,22 @@ static void usage () {
   printf ("-t <num>  number of worker threads (system default %d)\n",
     getsystemcores (0));
   printf ("--waitall wait for all threads to finish (for benchmarking)\n");
+  printf ("--pin=<placement> pin workers to processors and allocate on their\n");
+  printf ("          NUMA node: 'compact' (default), 'scatter' or 'none'\n");
+  printf ("--portfolio=<file> read worker configurations from file or\n");
+  printf ("          use 'none' to run all workers with the same options\n");
   printf ("\n");
 #endif
   printf ("-v     increase verbose level (see '--verbose')\n");
   printf ("-n     do not print witness (see '--witness')\n");
+  printf ("--cachefile=<file> resume from and save cached assignments\n");
+  printf ("--batch[=list]  solve each formula in the files listed in <file>\n");
+  printf ("--batch=stream  solve each of the formulas concatenated in <file>\n");
+  printf ("       (by default each instance stops after %d flips)\n",
+    BATCHFLIPS);
+#ifdef PALSAT
+  printf ("       (the flips limit is only supported in batch mode)\n");
+#endif
 #ifndef NDEBUG
   printf ("-l     enable internal logging (see '--logging')\n");
   printf ("-c     enable internal checking (see '--checking')\n");
@@ -613,12 +1400,18 @@ static void usage () {
 static void version () { printf ("%s\n", yals_version ()); }
 
 int main (int argc, char** argv) {
-  int i, ch, sign, lit, res, m, n;
+  int i, lit, res, m, n;
+  const char * err;
   for (i = 1; i < argc; i++) {
 #ifdef PALSAT
     if (!strcmp (argv[i], "-t")) { i++; continue; }
 #endif
     if (!strcmp (argv[i], "-v")) { verbose++; continue; }
+    if (!strcmp (argv[i], "--batch")) { batch = 1; continue; }
+    if (!strcmp (argv[i], "--batch=list")) { batch = 1; continue; }
+    if (!strcmp (argv[i], "--batch=stream")) { batch = 2; continue; }
+    if (!strncmp (argv[i], "--batch", 7))
+      die ("invalid batch mode in '%s' (try '-h')", argv[i]);
     if (!strcmp (argv[i], "--version")) { version (); exit (0); }
     if (!strcmp (argv[i], "-h")) { usage (); exit (0); }
   }
@@ -632,6 +1425,19 @@ int main (int argc, char** argv) {
   yals_banner ("c ");
 #ifdef PALSAT
   for (i = 1; i < argc; i++) {
+    if (!strncmp (argv[i], "--pin=", 6)) {
+      if (!strcmp (argv[i] + 6, "none")) pin = 0;
+      else if (!strcmp (argv[i] + 6, "compact")) pin = 1;
+      else if (!strcmp (argv[i] + 6, "scatter")) pin = 2;
+      else die ("invalid placement in '%s' (try '-h')", argv[i]);
+      continue;
+    }
+    if (!strncmp (argv[i], "--portfolio=", 12)) {
+      if (portfolio || nconfigs == 1)
+        die ("multiple '--portfolio' options (try '-h')");
+      readportfolio (argv[i] + 12);
+      continue;
+    }
     if (strcmp (argv[i], "-t")) continue;
     if (++i == argc) die ("argument to '-t' missing (try '-h')");
     if (threadset)
@@ -655,15 +1461,21 @@ int main (int argc, char** argv) {
   worker = mymalloc (0, threads * sizeof *worker);
   for (i = 0; i < threads; i++) {
     char prefix[80];
-    Yals * y = yals_new_with_mem_mgr (0, mymalloc, myrealloc, myfree);
+    Yals * y;
+    placeworker (i);
+    y = yals_new_with_mem_mgr (worker + i, mymalloc, myrealloc, myfree);
     yals_setmsglock (y, lockmsg, unlockmsg, 0);
     yals_seterm (y, workers_should_terminate, 0);
-//    if (i % 4 == 3) yals_setopt (y, "toggleuniform", 1);
     sprintf (prefix, "c %02d ", i);
     yals_setprefix (y, prefix);
     yals_setime (y, getime);
     worker[i].yals = y;
+    worker[i].config = batch ? 0 : i % nconfigs;
+    if (!batch) configure (i);
   }
+  if (nconfigs > 1 && !batch)
+    msg ("portfolio of %d configurations%s", nconfigs,
+      portfolio ? " (from file)" : "");
 #else
   yals = yals_new_with_mem_mgr (0, mymalloc, myrealloc, myfree);
   yals_setprefix (yals, "c ");
@@ -673,7 +1485,10 @@ int main (int argc, char** argv) {
 #ifdef PALSAT
     if (!strcmp (argv[i], "-t")) { i++; assert (i < argc); continue; }
     if (!strcmp (argv[i], "--waitall")) { waitall++; assert (i < argc); continue; }
+    if (!strncmp (argv[i], "--pin=", 6)) continue;
+    if (!strncmp (argv[i], "--portfolio=", 12)) continue;
 #endif
+    if (!strncmp (argv[i], "--batch", 7)) continue;
     if (!strcmp (argv[i], "-v"))
       setopt ("verbose", ++verbose);
     else if (!strcmp (argv[i], "-n"))
@@ -687,11 +1502,18 @@ int main (int argc, char** argv) {
     else if (!strcmp (argv[i], "--bfs")) setopt ("pick", 1);
     else if (!strcmp (argv[i], "--dfs")) setopt ("pick", 2);
     else if (!strcmp (argv[i], "--rfs")) setopt ("pick", 3);
+    else if (!strncmp (argv[i], "--cachefile=", 12)) {
+      if (cachefile) die ("multiple '--cachefile' options (try '-h')");
+      if (batch) die ("can not use '--cachefile' in batch mode");
+      if (!*(cachefile = argv[i] + 12)) die ("empty cache file name");
+    }
     else if (!strcmp (argv[i], "--pfs")) setopt ("pick", -1);
     else if (!strcmp (argv[i], "--ufs")) setopt ("pick", 0);
     else if (isnum (argv[i])) {
 #ifdef PALSAT
-      if (seedset) die ("seed already set (try '-h')");
+      if (flipsset || (seedset && !batch))
+        die ("seed already set (try '-h')");
+      else if (seedset) flips = atoll (argv[i]), flipsset = 1;
 #else
       if (memsset) die ("more than three numbers (try '-h')");
       else if (flipsset) mems = atoll (argv[i]), memsset = 1;
@@ -704,7 +1526,7 @@ int main (int argc, char** argv) {
       file = stdin, filename = "<stdin>";
       assert (!closefile);
     } else if (argv[i][0] == '-') {
-      if (!opt (argv[i]))
+      if (!opt (0, argv[i]))
         die ("invalid command line option '%s'", argv[i]);
     } else if (!isfile (argv[i]))
       die ("'%s' does not seem to be a file", argv[i]);
@@ -749,6 +1571,12 @@ int main (int argc, char** argv) {
       yals_srand (worker[i].yals, newseed);
       msg ("worker %d uses seed %llu", i, newseed);
     }
+    for (i = 0; !batch && i < threads; i++)
+      if (*configs[worker[i].config].opts)
+        msg ("worker %d uses configuration '%s': %s",
+          i, configs[worker[i].config].name, configs[worker[i].config].opts);
+      else msg ("worker %d uses configuration '%s'",
+          i, configs[worker[i].config].name);
   }
 #else
   if (flipsset) msg ("using specified flips limit %lld", flips);
@@ -757,87 +1585,49 @@ int main (int argc, char** argv) {
   else msg ("no mems limit set (by default)");
 #endif
   if (!file) file = stdin, filename = "<stdin>";
-  msg ("parsing '%s'", filename);
-HEADER:
-  ch = getc (file);
-  if (ch == 'c') {
-    while ((ch = getc (file)) != '\n')
-      if (ch == EOF) perr ("end-of-file in comment");
-    goto HEADER;
-  }
-  if (ch != 'p') perr ("expected 'p' or 'c'");
-  ungetc (ch, file);
-  if (fscanf (file, "p cnf %d %d", &m, &n) != 2 || m < 0 || n < 0) {
-    if (fscanf (file, "xnf %d %d", &m, &n) != 2 || m < 0 || n < 0)
-      perr ("invalid header");
+  if (batch) {
+    res = runbatches ();
+    if (closefile == 1) fclose (file);
+    if (closefile == 2) pclose (file);
+    resetsighandlers ();
+    goto DELETE;
   }
+  msg ("parsing '%s'", filename);
+  if ((res = parseheader (file, &m, &n, &err)) <= 0)
+    perr ("%s", res ? err : "expected 'p' or 'c'");
   msg ("parsed header 'p c/xnf %d %d'", m, n);
   V = m, C = n;
   msg ("clause variable ratio %.2f", average (C,V));
   lit = 0;
-BODY:
-  ch = getc (file);
-  if (ch == EOF) {
-    if (n >= 1) perr ("one clause missing");
-    if (n > 0) perr ("clauses missing");
+  if (closefile == 1 && parsemapped (&n, &lit)) {
+    if (n > 0) perr (n > 1 ? "clauses missing" : "one clause missing");
     if (lit) perr ("zero sentinel missing at end-of-file");
-    goto DONE;
-  }
-  if (ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n') goto BODY;
-  if (ch == 'c') {
-    while ((ch = getc (file)) != '\n')
-      if (ch == EOF) perr ("end-of-file in comment");
-    goto BODY;
-  }
-  if (ch == 'x') {
-#ifdef PALSAT
-    int i;
-    for (i = 0; i < threads; i++) {
-      yals_begin_xor_clause(worker[i].yals);
-    }
-#else
-    yals_begin_xor_clause(yals);
-#endif
-    goto BODY;
-  }
-  if (ch == '-') {
-    ch = getc (file);
-    if (ch == '0') perr ("expected non-zero digit");
-    sign = -1;
-  } else sign = 1;
-  if (!isdigit (ch)) perr ("expected digit");
-  lit = ch - '0';
-  while (isdigit (ch = getc (file)))
-    lit = 10*lit + (ch - '0');
-  if (ch != EOF && ch != ' ' && ch != '\r' && ch != '\n')
-    perr ("expected space or new-line");
-  if (lit > V) perr ("maximum variable index exceeded");
-  if (!n) perr ("too many clauses");
-  lit *= sign;
-  if (!lit) n--;
-#ifdef PALSAT
-  {
-    int i;
-    for (i = 0; i < threads; i++)
-      yals_add (worker[i].yals, lit);
-  }
-#else
-  yals_add (yals, lit);
-#endif
-  goto BODY;
-DONE:
+  } else if (parseclauses (YALS, file, 1, m, n, &err) < 0)
+    perr ("%s", err);
   if (closefile == 1) fclose (file);
   if (closefile == 2) pclose (file);
   msg ("finished parsing after %.2f seconds",  getime ());
-  msg ("allocated %.1f MB after parsing", mem.allocated/(double)(1<<20));
+  msg ("allocated %.1f MB after parsing", allocated ()/(double)(1<<20));
 #ifdef PALSAT
-  res = palsat ();
+  res = yals_prepare (YALS);
+  if (!res) {
+    for (i = 1; i < threads; i++) yals_attach (worker[i].yals, YALS);
+    msg ("all %d workers share the formula of worker 0", threads);
+    msg ("allocated %.1f MB after connecting",
+      allocated ()/(double)(1<<20));
+    readcache ();
+    res = palsat (run);
+    if (res) msg ("winning configuration '%s' of worker %d",
+      configs[worker[winner].config].name, winner);
+  }
 #else
   if (flipsset) yals_setflipslimit (yals, flips);
   if (memsset) yals_setmemslimit (yals, mems);
+  if (cachefile && !(res = yals_prepare (yals))) readcache ();
   res = yals_sat (yals);
   msg ("");
 #endif
+  if (res != 20) writecache ();
   if (res != 20) {
     if (res == 10) fputs ("s SATISFIABLE\n", stdout);
     else fputs ("s CURRENT BEST\n", stdout);
@@ -854,9 +1644,13 @@ DONE:
   fflush (stdout);
   resetsighandlers ();
   stats ();
+DELETE:
 #ifdef PALSAT
-  for (i = 0; i < threads; i++) yals_del (worker[i].yals);
+  for (i = threads - 1; i >= 0; i--) yals_del (worker[i].yals);
   myfree (0, worker, threads * sizeof *worker);
+  if (cpus) myfree (0, cpus, szcpus * sizeof *cpus);
+  if (portfolio)
+    myfree (0, portfolio, szportfolio);
 #else
   yals_del (yals);
 #endif
@@ -30,6 +30,11 @@
 #include <fpu_control.h>	// Set FPU to double precision on Linux.
 #endif
 
+#if defined(__GNUC__) && defined(__x86_64__)
+#define YALS_AVX2
+#include <immintrin.h>		// Vectorized scores selected by 'cpuid'.
+#endif
+
 /*------------------------------------------------------------------------*/
 
 #define YALS_INT64_MAX		(0x7fffffffffffffffll)
@@ -163,6 +168,12 @@ typedef unsigned Word;
 #define SWAP(T,A,B) \
   do { T TMP = (A); (A) = (B); (B) = (TMP); } while (0)
 
+#ifdef __GNUC__
+#define YALS_INLINE inline __attribute__((always_inline))
+#else
+#define YALS_INLINE inline
+#endif
+
 /*------------------------------------------------------------------------*/
 #ifndef NDEBUG
 #define LOG(ARGS...) \
@@ -221,11 +232,17 @@ enum ClausePicking {
   UNFAIR_BFS_CLAUSE_PICKING = 4,
 };
 
+enum CritMode {
+  CRIT_FLOAT = 1,
+  CRIT_FIXED = 2,
+};
+
 /*------------------------------------------------------------------------*/
 
 #define OPTSTEMPLATE \
   OPT (best,0,0,1,"always pick best assignment during restart"); \
   OPT (breakzero,0,0,1,"always use break zero literal if possible"); \
+  OPT (cachecompress,1,0,1,"delta compress cached assignments"); \
   OPT (cached,1,0,1,"use cached assignment during restart"); \
   OPT (cachedinv,0,0,1,"use inverse minimum for selecting cached assignments"); \
   OPT (cacheduni,0,0,1,"pick random cached assignment uniformly"); \
@@ -235,20 +252,30 @@ enum ClausePicking {
   OPT (correct,1,0,1,"correct CB value depending on maximum length"); \
   OPT (crit,1,0,1,"dynamic break values (using critical lits)"); \
   OPT (defrag,1,0,1,"defragemtation of unsat queue"); \
+  OPT (deque,0,0,1,"use array-backed deque instead of linked unsat queue"); \
+  OPT (elite,0,0,(1<<10),"elite pool size shared with attached instances"); \
   OPT (fixed,4,0,INT_MAX,"fixed default strategy frequency (1=always)"); \
   OPT (geomfreq,66,0,100,"geometric picking first frequency (percent)"); \
   OPT (hitlim,-1,-1,INT_MAX,"minimum hit limit"); \
+  OPT (intweights,0,0,1,"fixed-point integer break weights"); \
+  OPT (inlinesmall,0,0,1,"store binary and ternary clauses without offsets"); \
   OPT (keep,0,0,1,"keep assignment during restart"); \
+  OPT (keepcache,1,0,1,"keep cached assignments during outer restarts"); \
+  OPT (kernel,1,0,1,"use specialized flip kernels"); \
   OPT (minchunksize,(1<<8),2,(1<<20),"minium queue chunk size"); \
   OPT (pick,4,-1,4,"-1=pbfs,0=rnd,1=bfs,2=dfs,3=rbfs,4=ubfs"); \
   OPT (pol,-1,-1,1,"negative=-1 positive=1 or random=0 polarity"); \
   OPT (prep,1,0,1,"preprocessing through unit propagation"); \
+  OPT (records,0,0,1,"interleave satcnt, crit and weight per OR clause"); \
   OPT (rbfsrate,10,1,INT_MAX,"relaxed BFS rate"); \
   OPT (reluctant,1,0,1,"reluctant doubling of restart interval"); \
+  OPT (reorder,0,0,1,"renumber clauses and variables in BFS order"); \
   OPT (restart,100000,0,INT_MAX,"basic (inner) restart interval"); \
+  OPT (restartdiff,10,0,100,"incremental restart below percent of flipped variables"); \
   OPT (restartouter,0,0,1,"enable restart outer"); \
   OPT (restartouterfactor,100,1,INT_MAX,"outer restart interval factor"); \
   OPT (setfpu,1,0,1,"set FPU to use double precision on Linux"); \
+  OPT (simd,1,0,1,"vectorized break scores if AVX2 is available"); \
   OPT (termint,1000,0,INT_MAX,"termination call back check interval"); \
   OPT (toggleuniform,0,0,1,"toggle uniform strategy"); \
   OPT (unfairfreq,50,0,100,"unfair picking first frequency (percent)"); \
@@ -256,6 +283,8 @@ enum ClausePicking {
   OPT (unipick,-1,-1,4,"clause picking strategy for uniform formulas"); \
   OPT (unirestarts,0,0,INT_MAX,"max number restarts for uniform formulas"); \
   OPT (verbose,0,0,2,"set verbose level"); \
+  OPT (warm,1,0,1,"start next 'yals_sat' from previous best assignment"); \
+  OPT (wideoccs,0,0,1,"store lengths separately to allow more clauses"); \
   OPT (weight,5,1,7,"[DISABLED] maximum clause weight"); \
   OPT (weight2,200,0,1000,"clause weight times 100 for clause len == 2"); \
   OPT (weight3,300,0,1000,"clause weight times 100 for clause len == 3"); \
@@ -265,6 +294,7 @@ enum ClausePicking {
   OPT (weight7,300,0,1000,"clause weight times 100 for clause len == 7"); \
   OPT (weight8,300,0,1000,"clause weight times 100 for clause len >= 8"); \
   OPT (witness,0,0,1,"print witness"); \
+  OPT (xmasks,1,0,1,"word-parallel XOR parity evaluation on restarts"); \
   OPT (xorweight,500,0,1000,"constant weight of XOR clauses for weighted break, times a 100 (range 0.0-10.0)"); \
   OPT (maxorigvar,0,0,INT_MAX,"index (inclusive) of maximum original (non-auxilliary) variable in CNF-encoded XNF"); \
   OPTSTEMPLATENDEBUG
@@ -346,13 +376,14 @@ typedef struct Stats {
   int64_t flips, bzflips, hits, unsum;
   struct {
     struct { int64_t count; } outer;
-    struct { int64_t count, maxint; } inner;
+    struct { int64_t count, maxint, incremental, diffs; } inner;
   } restart;
   struct { struct { int chunks, lnks; } max; int64_t unfair; } queue;
-  struct { int64_t inserted, replaced, skipped; } cache;
+  struct { int64_t inserted, replaced, skipped, loaded; } cache;
   struct { int64_t search, neg, falsepos, truepos; } sig;
   struct { int64_t def, rnd; } strat;
-  struct { int64_t best, cached, keep, pos, neg, rnd; } pick;
+  struct { int64_t best, cached, elite, keep, pos, neg, rnd; } pick;
+  struct { int64_t published, busy, torn; } elite;
   struct { int64_t count, moved; } defrag;
   struct { size_t current, max; } allocated;
   struct { volatile double total, defrag, restart, entered; } time;
@@ -397,10 +428,21 @@ typedef struct Queue {
   Chunk * chunks;
 } Queue;
 
+// Array-backed alternative to 'Queue' if '--deque' is enabled.  Unsatisfied
+// clauses are kept in FIFO order in 'cidxs' starting at 'head'.  Dequeued
+// clauses leave a '-1' hole until the next compaction.  The first and last
+// entry are always live.  Positions are stored in 'pos' as for the stack.
+
+typedef struct Deque {
+  int head, count;
+  STACK(int) cidxs;
+} Deque;
+
 typedef struct Exp {
-  struct { STACK(double) two, cb; } table;
-  struct { unsigned two, cb; } max;
-  struct { double two, cb; } eps;
+  struct { STACK(double) two, cb, fixed; } table;
+  struct { unsigned two, cb, fixed; } max;
+  struct { double two, cb, fixed; } eps;
+  int cb;	// value of '--cb' the tables were computed for
 } Exp;
 
 typedef struct Opt { int val, def, min, max; } Opt;
@@ -417,6 +459,35 @@ typedef unsigned char U1;
 typedef unsigned short U2;
 typedef unsigned int U4;
 
+// Hot per-OR-clause record used instead of the separate 'satcnt', 'crit'
+// and 'weights' arrays if '--records' is enabled.
+
+typedef struct Rec {
+  unsigned satcnt;
+  int crit;
+  union { float weight; unsigned iweight; };
+} Rec;
+
+// One word of the assignment restricted to the variables of an XOR clause
+// if '--xmasks' is enabled (see 'yals_xorval').
+
+typedef struct XMask {
+  int word;
+  Word mask;
+} XMask;
+
+// Slot of the elite pool shared by all instances attached to the same
+// formula if '--elite' is non-zero (see 'yals_publish_elite').  The
+// sequence number is odd while the slot is written.  Readers check that it
+// did not change while copying 'vals'.
+
+typedef struct Elite {
+  unsigned seq;
+  int min;
+  Word sig;
+  Word * vals;
+} Elite;
+
 typedef struct FPU {
 #ifdef __linux__
   fpu_control_t control;
@@ -427,23 +498,45 @@ typedef struct FPU {
 struct Yals {
   RNG rng;
   FILE * out;
-  struct { int usequeue; Queue queue; STACK(int) stack; } unsat;
+  struct {
+    int usequeue, usedeque;
+    Queue queue; Deque deque; STACK(int) stack;
+  } unsat;
   int nvars;
   // Stores offsets into `occs` of literals. See `yals_(x)refs`
   int * refs;
   // Number of times each var is flipped
   int64_t * flips;
+  // If '--reorder' renumbered variables, the internal index of external
+  // variables and vice versa (see `yals_reorder`)
+  int * e2i, * i2e;
   STACK(signed char) mark;
   // Whether the current parsing clause is trivial (contains x and -x)
   int trivial;
   // Whether the formula is false (contains empty clause)
   int mt;
+  // Whether the formula is connected (see 'yals_prepare')
+  int prepared;
+  // If non-zero the instance owning the connected formula, which is only
+  // shared read-only with this instance (see 'yals_attach')
+  Yals * master;
+  // Number of instances attached to this one
+  int attached;
+  // Clauses added after 'yals_prepare' start at these positions of 'cdb'
+  // and 'xcdb' and together with the units on 'trail' are connected by
+  // the next 'yals_sat' (see 'yals_extend_formula').  Until then new
+  // variables are only counted in 'addednvars'.
+  int addedcdb, addedxcdb, addednvars;
+  // Whether the next search starts from the previous best assignment
+  int warm;
   // During parsing of a XOR clause, its parity. Unused elsewhere
   int xorParity;
   int uniform, pick;
   // The working assignment, a bitfield
   Word * vals;
   Word * best, * tmp;
+  // The assignment before an inner restart (see 'yals_restart_sat_and_unsat')
+  Word * old;
   // Parts of the assignment forced by unit propagation. See `yals_set_units`
   // `clear` has 0s for vars which must be false
   Word * clear;
@@ -455,14 +548,22 @@ struct Yals {
   STACK(int) cdb;
   // XOR clause database. Like `cdb`, but only variable indices are stored - not literals
   STACK(int) xcdb;
-  // PEEK(xparitydb, cidx) is the parity of the cidx-th XOR clause. That is,
+  // Bit `cidx` of `xparitydb` is the parity of the cidx-th XOR clause. That is,
   // - 0 iff the clause is true when an odd number of *variables* in it are
   // - 1 iff even number
-  // TODO(WN): bitfield would do
-  STACK(int) xparitydb;
+  // See `yals_xparity`
+  STACK(Word) xparitydb;
+  // Number of parity bits stored in `xparitydb`
+  int nxparities;
   // Trail includes all the unit clauses
   STACK(int) trail;
   STACK(int) phases;
+  // Literals assumed for the next 'yals_sat' call only (see 'yals_assume')
+  STACK(int) assumptions;
+  // During a call with assumptions 'set' and 'clear' point to copies which
+  // also fix the assumed variables and 'frozen' has 1s for them.  The
+  // original masks are saved in 'unitset' and 'unitclear'.
+  Word * frozen, * unitset, * unitclear;
   // During parsing, the clause being parsed. Not used elsewhere
   STACK(int) clause;
   // During parsing, whether the current clause is OR (0) or XOR (1)
@@ -472,29 +573,55 @@ struct Yals {
   int satcntbytes;
   // For the cidx-th OR clause, satcntN[cidx] is the number of SAT literals in it
   union { U1 * satcnt1; U2 * satcnt2; U4 * satcnt4; };
-  // For the cidx-th XOR clause, xorsat[cidx] is 1 iff that clause is SAT
-  // TODO(WN): bitfield would do
-  U1 * xorsat;
+  // If non-zero replaces `satcntN`, `crit` and `weights` (see `Rec`)
+  Rec * recs;
+  // For the cidx-th XOR clause, bit `cidx` of `xorsat` is 1 iff that clause is SAT
+  Word * xorsat;
+  // Number of machine words of `xorsat`
+  int nxwords;
   // Variable occurrences in clauses. See `yals_(x)occs`
   // Format:
   // flatten([ [ (clause idx << MAXLEN | clause length) for OR clauses in which `x` occurs ] ++ [ -1 ] ++
   //           [ (clause idx << MAXLEN | clause length) for OR clauses in which `-x` occurs ] ++ [ -1 ] ++
   //           [ (clause idx << MAXLEN | clause length) for XOR clauses in which `x` occurs ] ++ [ -1 ] for x in variables ])
+  // If `wideoccs` is set only the clause idx is stored and the capped
+  // length of OR clauses is kept in `lens` (see `yals_occ_cidx`)
   int * occs;
+  int wideoccs;
+  U1 * lens;
   // Number of total occurrences of literals in OR clauses
   int noccs;
+  // Size of occurrence lists in 'occs' abandoned by 'yals_extend_occs'
+  int garbageoccs;
   // Number of total occurrences of literals in XOR clauses
   int nxoccs;
   float * weights;
   float xorweight;
+  // Weights in hundredths if `usecrit` is CRIT_FIXED (see '--intweights')
+  unsigned * iweights;
+  unsigned ixorweight;
   int * pos;
-  // lits[n] is the position in cdb of the n-th OR clause
+  // lits[n] is the position in cdb of the n-th OR clause. If `inlinesmall`
+  // is set, binary and ternary clauses are stored first in cdb and only
+  // large clauses have an entry in `lits` (see `yals_lits`)
   int * lits;
+  int inlinesmall;
   // xlits[n] is the position in xcdb of the n-th XOR clause
   int * xlits;
+  // If non-zero, xmasks[xmaskrefs[n]] up to xmasks[xmaskrefs[n+1]] are the
+  // words of `vals` covering the variables of the n-th XOR clause
+  XMask * xmasks; int * xmaskrefs; int nxmasks;
+  // Elite pool allocated by the first 'yals_attach' (see 'Elite')
+  Elite * elites; int nelites;
   Lnk ** lnk;
-  int * crit; float * weightedbreak;
-  float * xweightedbreak;
+  // Flip function selected in `yals_select_flip_kernel`
+  void (*flip) (Yals *);
+  // Whether break values are computed dynamically using critical literals
+  // with float weights (CRIT_FLOAT) or fixed-point weights (CRIT_FIXED)
+  int usecrit;
+  int * crit;
+  union { float * weightedbreak; unsigned * iweightedbreak; };
+  union { float * xweightedbreak; unsigned * ixweightedbreak; };
   // Number of OR clauses
   int nclauses;
   // Number of XOR clauses
@@ -508,8 +635,18 @@ struct Yals {
   // How many clauses flipping a literal would break
   STACK(float) breaks;
   STACK(double) scores;
+  // Whether 'yals_compute_scores_avx2' is used (see '--simd')
+  int avx2;
   STACK(int) cands;
-  STACK(Word*) cache; int cachesizetarget; STACK(Word) sigs;
+  STACK(unsigned char*) cache; int cachesizetarget; STACK(Word) sigs;
+  // Encoded cached assignments (see 'yals_cache_encode')
+  STACK(int) cachesizes; STACK(unsigned char) cachebuf; Word * cacheref;
+  // Index of the cache (see 'yals_cache_hash_insert')
+  int * cachehash; int cachehashsize, cachebest;
+  STACK(int) cacheheap, cacheheappos;
+  // Hash of the original formula identifying persisted caches and whether
+  // the first assignment should be picked from a loaded cache
+  uint64_t fingerprint; int cacheloaded;
   STACK(int) minlits;
   Callbacks cbs;
   Limits limits;
@@ -763,14 +900,16 @@ void yals_srand (Yals * yals, unsigned long long seed) {
   yals_msg (yals, 2, "setting random seed %llu", seed);
 }
 
-static unsigned yals_rand (Yals * yals) {
+static unsigned yals_rng (RNG * rng) {
   unsigned res;
-  yals->rng.z = 36969 * (yals->rng.z & 65535) + (yals->rng.z >> 16);
-  yals->rng.w = 18000 * (yals->rng.w & 65535) + (yals->rng.w >> 16);
-  res = (yals->rng.z << 16) + yals->rng.w;
+  rng->z = 36969 * (rng->z & 65535) + (rng->z >> 16);
+  rng->w = 18000 * (rng->w & 65535) + (rng->w >> 16);
+  res = (rng->z << 16) + rng->w;
   return res;
 }
 
+static unsigned yals_rand (Yals * yals) { return yals_rng (&yals->rng); }
+
 static unsigned yals_rand_mod (Yals * yals, unsigned mod) {
   unsigned res;
   assert (mod >= 1);
@@ -812,6 +951,19 @@ static int * yals_xoccs (Yals * yals, int idx) {
   return yals->occs + xoccs;
 }
 
+// Decoding of occurrences, instantiated with a constant 'wide' by the
+// flip kernels.  The length is only needed for weighted critical updates.
+
+static YALS_INLINE int
+yals_occ_cidx (int occ, const int wide) {
+  return wide ? occ : occ >> LENSHIFT;
+}
+
+static YALS_INLINE int
+yals_occ_len (Yals * yals, int occ, const int wide) {
+  return wide ? yals->lens[occ] : occ & LENMASK;
+}
+
 static int yals_val (Yals * yals, int lit) {
   int idx = ABS (lit), res = !GETBIT (yals->vals, yals->nvarwords, idx);
   if (lit > 0) res = !res;
@@ -826,20 +978,20 @@ static int yals_best (Yals * yals, int lit) {
 
 static float yals_weighted_break (Yals * yals, int lit) {
   int idx = ABS (lit);
-  assert (yals->crit);
+  assert (yals->usecrit);
   assert_valid_idx (idx);
   return yals->weightedbreak[2*idx + (lit < 0)];
 }
 
 static float yals_xweighted_break (Yals * yals, int idx) {
-  assert (yals->crit);
+  assert (yals->usecrit);
   assert_valid_idx (idx);
   return yals->xweightedbreak[idx];
 }
 
 static void yals_inc_weighted_break (Yals * yals, int lit, float w) {
   int idx = ABS (lit), pos;
-  assert (yals->crit);
+  assert (yals->usecrit);
   assert_valid_idx (idx);
   pos = 2*idx + (lit < 0);
   yals->weightedbreak[pos] += w;
@@ -848,7 +1000,7 @@ static void yals_inc_weighted_break (Yals * yals, int lit, float w) {
 }
 
 static void yals_inc_xweighted_break (Yals * yals, int idx, float w) {
-  assert (yals->crit);
+  assert (yals->usecrit);
   assert_valid_idx (idx);
   yals->xweightedbreak[idx] += w;
   assert (yals->xweightedbreak[idx] >= w);
@@ -857,7 +1009,7 @@ static void yals_inc_xweighted_break (Yals * yals, int idx, float w) {
 
 static void yals_dec_weighted_break (Yals * yals, int lit, float w) {
   int idx = ABS (lit), pos;
-  assert (yals->crit);
+  assert (yals->usecrit);
   assert_valid_idx (idx);
   pos = 2*idx + (lit < 0);
   assert (yals->weightedbreak[pos] >= w);
@@ -866,15 +1018,105 @@ static void yals_dec_weighted_break (Yals * yals, int lit, float w) {
 }
 
 static void yals_dec_xweighted_break (Yals * yals, int idx, float w) {
-  assert (yals->crit);
+  assert (yals->usecrit);
   assert_valid_idx (idx);
   assert (yals->xweightedbreak[idx] >= w);
   yals->xweightedbreak[idx] -= w;
   INC (weight);
 }
 
+// Fixed-point versions of the functions above.
+
+static unsigned yals_iweighted_break (Yals * yals, int lit) {
+  int idx = ABS (lit);
+  assert (yals->usecrit == CRIT_FIXED);
+  assert_valid_idx (idx);
+  return yals->iweightedbreak[2*idx + (lit < 0)];
+}
+
+static unsigned yals_ixweighted_break (Yals * yals, int idx) {
+  assert (yals->usecrit == CRIT_FIXED);
+  assert_valid_idx (idx);
+  return yals->ixweightedbreak[idx];
+}
+
+static void yals_inc_iweighted_break (Yals * yals, int lit, unsigned w) {
+  int idx = ABS (lit), pos;
+  assert (yals->usecrit == CRIT_FIXED);
+  assert_valid_idx (idx);
+  pos = 2*idx + (lit < 0);
+  assert (UINT_MAX - yals->iweightedbreak[pos] >= w);
+  yals->iweightedbreak[pos] += w;
+  INC (weight);
+}
+
+static void yals_inc_ixweighted_break (Yals * yals, int idx, unsigned w) {
+  assert (yals->usecrit == CRIT_FIXED);
+  assert_valid_idx (idx);
+  assert (UINT_MAX - yals->ixweightedbreak[idx] >= w);
+  yals->ixweightedbreak[idx] += w;
+  INC (weight);
+}
+
+static void yals_dec_iweighted_break (Yals * yals, int lit, unsigned w) {
+  int idx = ABS (lit), pos;
+  assert (yals->usecrit == CRIT_FIXED);
+  assert_valid_idx (idx);
+  pos = 2*idx + (lit < 0);
+  assert (yals->iweightedbreak[pos] >= w);
+  yals->iweightedbreak[pos] -= w;
+  INC (weight);
+}
+
+static void yals_dec_ixweighted_break (Yals * yals, int idx, unsigned w) {
+  assert (yals->usecrit == CRIT_FIXED);
+  assert_valid_idx (idx);
+  assert (yals->ixweightedbreak[idx] >= w);
+  yals->ixweightedbreak[idx] -= w;
+  INC (weight);
+}
+
+// Dispatch on the (in the flip kernels constant) 'crit' mode.
+
+static YALS_INLINE void
+yals_inc_len_break (Yals * yals, int lit, int len, const int crit) {
+  if (crit == CRIT_FIXED) yals_inc_iweighted_break (yals, lit, yals->iweights[len]);
+  else yals_inc_weighted_break (yals, lit, yals->weights[len]);
+}
+
+static YALS_INLINE void
+yals_dec_len_break (Yals * yals, int lit, int len, const int crit) {
+  if (crit == CRIT_FIXED) yals_dec_iweighted_break (yals, lit, yals->iweights[len]);
+  else yals_dec_weighted_break (yals, lit, yals->weights[len]);
+}
+
+static YALS_INLINE void
+yals_inc_rec_break (Yals * yals, int lit, const Rec * r, const int crit) {
+  if (crit == CRIT_FIXED) yals_inc_iweighted_break (yals, lit, r->iweight);
+  else yals_inc_weighted_break (yals, lit, r->weight);
+}
+
+static YALS_INLINE void
+yals_dec_rec_break (Yals * yals, int lit, const Rec * r, const int crit) {
+  if (crit == CRIT_FIXED) yals_dec_iweighted_break (yals, lit, r->iweight);
+  else yals_dec_weighted_break (yals, lit, r->weight);
+}
+
+static YALS_INLINE void
+yals_inc_xor_break (Yals * yals, int idx, const int crit) {
+  if (crit == CRIT_FIXED) yals_inc_ixweighted_break (yals, idx, yals->ixorweight);
+  else yals_inc_xweighted_break (yals, idx, yals->xorweight);
+}
+
+static YALS_INLINE void
+yals_dec_xor_break (Yals * yals, int idx, const int crit) {
+  if (crit == CRIT_FIXED) yals_dec_ixweighted_break (yals, idx, yals->ixorweight);
+  else yals_dec_xweighted_break (yals, idx, yals->xorweight);
+}
+
 static unsigned yals_satcnt (Yals * yals, int cidx) {
   assert_valid_cidx (cidx);
+  if (yals->recs) return yals->recs[cidx].satcnt;
   if (yals->satcntbytes == 1) return yals->satcnt1[cidx];
   if (yals->satcntbytes == 2) return yals->satcnt2[cidx];
   return yals->satcnt4[cidx];
@@ -882,7 +1124,9 @@ static unsigned yals_satcnt (Yals * yals, int cidx) {
 
 static void yals_setsatcnt (Yals * yals, int cidx, unsigned satcnt) {
   assert_valid_cidx (cidx);
-  if (yals->satcntbytes == 1) {
+  if (yals->recs) {
+    yals->recs[cidx].satcnt = satcnt;
+  } else if (yals->satcntbytes == 1) {
     assert (satcnt < 256);
     yals->satcnt1[cidx] = satcnt;
   } else if (yals->satcntbytes == 2) {
@@ -893,14 +1137,62 @@ static void yals_setsatcnt (Yals * yals, int cidx, unsigned satcnt) {
   }
 }
 
-static unsigned yals_incsatcnt (Yals * yals, int cidx, int lit, int len) {
+// The functions below are instantiated with compile time constant
+// 'satcntbytes', 'recs', 'wide' and 'crit' arguments by the flip kernels (see
+// 'FLIPKERNELSTEMPLATE'), which removes the corresponding branches.
+
+static YALS_INLINE unsigned
+yals_incsatcnt_rec (Yals * yals, int cidx, int lit, const int crit) {
+  Rec * r = yals->recs + cidx;
+  unsigned res = r->satcnt++;
+  assert (r->satcnt);
+#ifndef NYALSTATS
+  assert (res + 1 <= yals->maxlen);
+  yals->stats.inc[res]++;
+#endif
+  if (crit) {
+    if (res == 1) yals_dec_rec_break (yals, r->crit, r, crit);
+    else if (!res) yals_inc_rec_break (yals, lit, r, crit);
+    r->crit ^= lit;
+    assert (res || r->crit == lit);
+  }
+  return res;
+}
+
+static YALS_INLINE unsigned
+yals_decsatcnt_rec (Yals * yals, int cidx, int lit, const int crit) {
+  Rec * r = yals->recs + cidx;
+  unsigned res;
+  assert (r->satcnt);
+  res = --r->satcnt;
+#ifndef NYALSTATS
+  assert (res + 1 <= yals->maxlen);
+  yals->stats.dec[res + 1]++;
+#endif
+  if (crit) {
+    int other = r->crit ^ lit;
+    r->crit = other;
+    if (res == 1) yals_inc_rec_break (yals, other, r, crit);
+    else if (!res) yals_dec_rec_break (yals, lit, r, crit);
+    assert (res || !r->crit);
+  }
+  return res;
+}
+
+static YALS_INLINE unsigned
+yals_incsatcnt (Yals * yals, int cidx, int lit, int len,
+                const int satcntbytes, const int recs, const int crit) {
   unsigned res;
   assert_valid_cidx (cidx);
   assert_valid_len (len);
-  if (yals->satcntbytes == 1) {
+  assert (satcntbytes == yals->satcntbytes);
+  assert (recs == (yals->recs != 0));
+  assert (crit == yals->usecrit);
+  if (recs) return yals_incsatcnt_rec (yals, cidx, lit, crit);
+  if (satcntbytes == 1) {
     res = yals->satcnt1[cidx]++;
     assert (yals->satcnt1[cidx]);
-  } else if (yals->satcntbytes == 2) {
+  } else if (satcntbytes == 2) {
     res = yals->satcnt2[cidx]++;
     assert (yals->satcnt2[cidx]);
   } else {
@@ -911,23 +1203,29 @@ static unsigned yals_incsatcnt (Yals * yals, int cidx, int lit, int len) {
   assert (res + 1 <= yals->maxlen);
   yals->stats.inc[res]++;
 #endif
-  if (yals->crit) {
-    if (res == 1) yals_dec_weighted_break (yals, yals->crit[cidx], yals->weights[len]); // TODO avoid mem on yals->weights if uniform weights
-    else if (!res) yals_inc_weighted_break (yals, lit, yals->weights[len]);
+  if (crit) {
+    if (res == 1) yals_dec_len_break (yals, yals->crit[cidx], len, crit); // TODO avoid mem on yals->weights if uniform weights
+    else if (!res) yals_inc_len_break (yals, lit, len, crit);
     yals->crit[cidx] ^= lit;
     assert (res || yals->crit[cidx] == lit);
   }
   return res;
 }
 
-static unsigned yals_decsatcnt (Yals * yals, int cidx, int lit, int len) {
+static YALS_INLINE unsigned
+yals_decsatcnt (Yals * yals, int cidx, int lit, int len,
+                const int satcntbytes, const int recs, const int crit) {
   unsigned res;
   assert_valid_cidx (cidx);
   assert_valid_len (len);
-  if (yals->satcntbytes == 1) {
+  assert (satcntbytes == yals->satcntbytes);
+  assert (recs == (yals->recs != 0));
+  assert (crit == yals->usecrit);
+  if (recs) return yals_decsatcnt_rec (yals, cidx, lit, crit);
+  if (satcntbytes == 1) {
     assert (yals->satcnt1[cidx]);
     res = --yals->satcnt1[cidx];
-  } else if (yals->satcntbytes == 2) {
+  } else if (satcntbytes == 2) {
     assert (yals->satcnt2[cidx]);
     res = --yals->satcnt2[cidx];
   } else {
@@ -938,11 +1236,11 @@ static unsigned yals_decsatcnt (Yals * yals, int cidx, int lit, int len) {
   assert (res + 1 <= yals->maxlen);
   yals->stats.dec[res + 1]++;
 #endif
-  if (yals->crit) {
+  if (crit) {
     int other = yals->crit[cidx] ^ lit;
     yals->crit[cidx] = other;
-    if (res == 1) yals_inc_weighted_break (yals, other, yals->weights[len]); // TODO avoid mem on yals->weights if uniform weights
-    else if (!res) yals_dec_weighted_break (yals, lit, yals->weights[len]);
+    if (res == 1) yals_inc_len_break (yals, other, len, crit); // TODO avoid mem on yals->weights if uniform weights
+    else if (!res) yals_dec_len_break (yals, lit, len, crit);
     assert (res || !yals->crit[cidx]);
   }
   return res;
@@ -950,25 +1248,75 @@ static unsigned yals_decsatcnt (Yals * yals, int cidx, int lit, int len) {
 
 static U1 yals_xorsat (Yals * yals, int cidx) {
   assert_valid_xcidx(cidx);
-  return yals->xorsat[cidx];
+  return GETBIT (yals->xorsat, yals->nxwords, cidx) != 0;
 }
 
-static void yals_setxorsat (Yals * yals, int cidx, U1 xorsat) {
+static U1 yals_flipxorsat (Yals * yals, int cidx) {
   assert_valid_xcidx (cidx);
-  yals->xorsat[cidx] = xorsat;
+  NOTBIT (yals->xorsat, yals->nxwords, cidx);
+  return yals_xorsat (yals, cidx);
 }
 
-static U1 yals_flipxorsat (Yals * yals, int cidx) {
-  assert_valid_xcidx (cidx);
-  yals->xorsat[cidx] ^= 1;
-  return yals->xorsat[cidx];
+static U1 yals_xparity (Yals * yals, int cidx) {
+  assert (0 <= cidx && cidx < yals->nxparities);
+  return GETBIT (yals->xparitydb.start, COUNT (yals->xparitydb), cidx) != 0;
+}
+
+static void yals_setxparity (Yals * yals, int cidx, U1 parity) {
+  assert (0 <= cidx && cidx < yals->nxparities);
+  if (parity) SETBIT (yals->xparitydb.start, COUNT (yals->xparitydb), cidx);
+  else CLRBIT (yals->xparitydb.start, COUNT (yals->xparitydb), cidx);
+}
+
+static void yals_push_xparity (Yals * yals, U1 parity) {
+  if (!(yals->nxparities & BITMAPMASK)) PUSH (yals->xparitydb, 0);
+  yals_setxparity (yals, yals->nxparities++, parity);
+}
+
+static int yals_ctz (Word w) {
+  assert (w);
+#ifdef __GNUC__
+  return __builtin_ctz (w);
+#else
+  int res = 0;
+  while (!(w & 1)) w >>= 1, res++;
+  return res;
+#endif
+}
+
+static int yals_popcount (Word w) {
+#ifdef __GNUC__
+  return __builtin_popcount (w);
+#else
+  int res = 0;
+  while (w) w &= w - 1, res++;
+  return res;
+#endif
+}
+
+// Returns the literals for the cidx-th OR clause without counting mems.
+static int * yals_lits_nomems (Yals * yals, int cidx) {
+  assert_valid_cidx (cidx);
+  if (yals->inlinesmall) {
+    if (cidx < yals->nbin) return yals->cdb.start + 3*cidx;
+    cidx -= yals->nbin;
+    if (cidx < yals->ntrn) return yals->cdb.start + 3*yals->nbin + 4*cidx;
+    cidx -= yals->ntrn;
+  }
+  return yals->cdb.start + yals->lits[cidx];
 }
 
 // Returns the literals for the cidx-th OR clause
 static int * yals_lits (Yals * yals, int cidx) {
   INC (lits);
-  assert_valid_cidx (cidx);
-  return yals->cdb.start + yals->lits[cidx];
+  return yals_lits_nomems (yals, cidx);
+}
+
+// Number of entries in `yals->lits`
+static int yals_nlits (Yals * yals) {
+  int res = yals->nclauses;
+  if (yals->inlinesmall) res -= yals->nbin + yals->ntrn;
+  return res;
 }
 
 // Returns the variable indices for the cidx-th XOR clause
@@ -998,9 +1346,15 @@ static void yals_report (Yals * yals, const char * fmt, ...) {
   yals_msgunlock (yals);
 }
 
+static YALS_INLINE int yals_nunsat_kernel (Yals * yals, const int usequeue) {
+  assert (usequeue == yals->unsat.usequeue);
+  if (!usequeue) return COUNT (yals->unsat.stack);
+  else if (yals->unsat.usedeque) return yals->unsat.deque.count;
+  else return yals->unsat.queue.count;
+}
+
 static int yals_nunsat (Yals * yals) {
-  if (yals->unsat.usequeue) return yals->unsat.queue.count;
-  else return COUNT (yals->unsat.stack);
+  return yals_nunsat_kernel (yals, yals->unsat.usequeue);
 }
 
 static void yals_save_new_minimum (Yals * yals) {
@@ -1046,7 +1400,7 @@ static void yals_check_global_invariant (Yals * yals) {
       if (yals_val (yals, lit)) sat++;
     assert (yals_satcnt (yals, cidx) == sat);
     if (!sat) nunsat++;
-    if (yals->unsat.usequeue) {
+    if (yals->unsat.usequeue && !yals->unsat.usedeque) {
       if (sat) continue;
       Lnk * l = yals->lnk[cidx];
       assert (l);
@@ -1054,20 +1408,23 @@ static void yals_check_global_invariant (Yals * yals) {
     } else {
       int pos = yals->pos[cidx];
       if (sat) assert (pos < 0);
-      else {
+      else if (yals->unsat.usedeque) {
+        assert (yals->unsat.deque.head <= pos);
+        assert (PEEK (yals->unsat.deque.cidxs, pos) == cidx);
+      } else {
         assert_valid_pos (pos);
         assert (PEEK (yals->unsat.stack, pos) == cidx);
       }
     }
   }
   for (cidx = 0; cidx < yals->nxclauses; cidx++) {
-    U1 sat = *(yals->xparitydb.start + cidx);
+    U1 sat = yals_xparity (yals, cidx);
     for (p = yals_xlits(yals, cidx); (lit = *p); p++) {
       sat ^= yals_val(yals, lit);
     }
     assert (yals_xorsat(yals, cidx) == sat);
     if (!sat) nunsat++;
-    if (yals->unsat.usequeue) {
+    if (yals->unsat.usequeue && !yals->unsat.usedeque) {
       if (sat) continue;
       Lnk * l = yals->lnk[cidx + yals->nclauses];
       assert (l);
@@ -1075,7 +1432,10 @@ static void yals_check_global_invariant (Yals * yals) {
     } else {
       int pos = yals->pos[cidx + yals->nclauses];
       if (sat) assert (pos < 0);
-      else {
+      else if (yals->unsat.usedeque) {
+        assert (yals->unsat.deque.head <= pos);
+        assert (PEEK (yals->unsat.deque.cidxs, pos) == cidx + yals->nclauses);
+      } else {
         assert_valid_pos (pos);
         assert (PEEK (yals->unsat.stack, pos) == cidx + yals->nclauses);
       }
@@ -1121,6 +1481,88 @@ static void yals_dequeue_lnk (Yals * yals, Lnk * l) {
 
 /*------------------------------------------------------------------------*/
 
+// Moves the live entries of the deque to the front.  Triggered if less
+// than half of the used part of 'cidxs' is live, which keeps walking over
+// holes in relaxed BFS picking cheap and the deque cache dense.  Counted
+// as defragmentation in the statistics.
+
+static void yals_compact_deque (Yals * yals) {
+  Deque * d = &yals->unsat.deque;
+  double start = yals_time (yals);
+  int * p, * q, cidx;
+  yals->stats.defrag.count++;
+  yals->stats.defrag.moved += d->count;
+  LOG ("compacting deque of size %d with %d live entries",
+    (int) COUNT (d->cidxs) - d->head, d->count);
+  q = d->cidxs.start;
+  for (p = q + d->head; p < d->cidxs.top; p++) {
+    if ((cidx = *p) < 0) continue;
+    yals->pos[cidx] = q - d->cidxs.start;
+    *q++ = cidx;
+  }
+  assert (q - d->cidxs.start == d->count);
+  d->cidxs.top = q;
+  d->head = 0;
+  yals->stats.time.defrag += yals_time (yals) - start;
+}
+
+static void yals_enqueue_deque (Yals * yals, int cidx) {
+  Deque * d = &yals->unsat.deque;
+  int size;
+  assert (yals->unsat.usedeque);
+  assert (yals->pos[cidx] < 0);
+  yals->pos[cidx] = COUNT (d->cidxs);
+  PUSH (d->cidxs, cidx);
+  d->count++;
+  if (yals->stats.maxstacksize < (size = SIZE (d->cidxs)))
+    yals->stats.maxstacksize = size;
+}
+
+static void yals_dequeue_deque (Yals * yals, int cidx) {
+  Deque * d = &yals->unsat.deque;
+  int pos = yals->pos[cidx];
+  assert (yals->unsat.usedeque);
+  assert (d->count > 0);
+  assert (d->head <= pos);
+  assert (PEEK (d->cidxs, pos) == cidx);
+  POKE (d->cidxs, pos, -1);
+  yals->pos[cidx] = -1;
+  d->count--;
+  if (pos == d->head)
+    while (d->head < COUNT (d->cidxs) && PEEK (d->cidxs, d->head) < 0)
+      d->head++;
+  while (COUNT (d->cidxs) > d->head && TOP (d->cidxs) < 0)
+    (void) POP (d->cidxs);
+  if (!d->count) {
+    CLEAR (d->cidxs);
+    d->head = 0;
+  } else if (COUNT (d->cidxs) > 2*d->count + yals->opts.minchunksize.val)
+    yals_compact_deque (yals);
+}
+
+// Position of the next live entry after 'pos' or '-1' if 'pos' is last.
+
+static int yals_next_deque (Yals * yals, int pos) {
+  const Deque * d = &yals->unsat.deque;
+  const int n = COUNT (d->cidxs);
+  while (++pos < n)
+    if (d->cidxs.start[pos] >= 0)
+      return pos;
+  return -1;
+}
+
+static void yals_reset_unsat_deque (Yals * yals) {
+  Deque * d = &yals->unsat.deque;
+  const int * p;
+  assert (yals->unsat.usedeque);
+  for (p = d->cidxs.start + d->head; p < d->cidxs.top; p++)
+    if (*p >= 0) yals->pos[*p] = -1;
+  RELEASE (d->cidxs);
+  d->head = d->count = 0;
+}
+
+/*------------------------------------------------------------------------*/
+
 static const char * yals_pick_to_str (Yals * yals) {
   switch (yals->pick) {
     case BFS_CLAUSE_PICKING:
@@ -1140,20 +1582,44 @@ static const char * yals_pick_to_str (Yals * yals) {
   }
 }
 
-static int yals_pick_clause (Yals * yals) {
-  int cidx, nunsat = yals_nunsat (yals);
+static YALS_INLINE int yals_pick_clause (Yals * yals, const int pick) {
+  const int usequeue = (pick > 0);
+  int cidx = -1, nunsat = yals_nunsat_kernel (yals, usequeue);
+  assert (pick == yals->pick);
   assert (nunsat > 0);
  int iter = 2;
  while (iter-- > 0) {
-  if (yals->unsat.usequeue) {
+  if (usequeue && yals->unsat.usedeque) {
+    Deque * d = &yals->unsat.deque;
+    if (pick == BFS_CLAUSE_PICKING) {
+      cidx = PEEK (d->cidxs, d->head);
+    } else if (pick == RELAXED_BFS_CLAUSE_PICKING) {
+      int pos = d->head, next;
+      while ((next = yals_next_deque (yals, pos)) >= 0 &&
+             !yals_rand_mod (yals, yals->opts.rbfsrate.val))
+        pos = next;
+      cidx = PEEK (d->cidxs, pos);
+    } else if (pick == UNFAIR_BFS_CLAUSE_PICKING) {
+      cidx = PEEK (d->cidxs, d->head);
+      if (d->count > 1 && yals_rand_mod (yals, 100) < 50) {
+        yals_dequeue_deque (yals, cidx);
+        yals_enqueue_deque (yals, cidx);
+        yals->stats.queue.unfair++;
+      }
+      cidx = PEEK (d->cidxs, d->head);
+    } else {
+      assert (pick == DFS_CLAUSE_PICKING);
+      cidx = TOP (d->cidxs);
+    }
+  } else if (usequeue) {
     Lnk * lnk;
-    if (yals->pick == BFS_CLAUSE_PICKING) {
+    if (pick == BFS_CLAUSE_PICKING) {
       lnk = yals->unsat.queue.first;
-    } else if (yals->pick == RELAXED_BFS_CLAUSE_PICKING) {
+    } else if (pick == RELAXED_BFS_CLAUSE_PICKING) {
       lnk = yals->unsat.queue.first;
       while (lnk->next && !yals_rand_mod (yals, yals->opts.rbfsrate.val))
         lnk = lnk->next;
-    } else if (yals->pick == UNFAIR_BFS_CLAUSE_PICKING) {
+    } else if (pick == UNFAIR_BFS_CLAUSE_PICKING) {
       lnk = yals->unsat.queue.first;
       cidx = lnk->cidx;
       if (yals->unsat.queue.count > 1 &&
@@ -1169,17 +1635,17 @@ static int yals_pick_clause (Yals * yals) {
       }
       lnk = yals->unsat.queue.first;
     } else {
-      assert (yals->pick == DFS_CLAUSE_PICKING);
+      assert (pick == DFS_CLAUSE_PICKING);
       lnk = yals->unsat.queue.last;
     }
     assert (lnk);
     cidx = lnk->cidx;
   } else {
     int cpos;
-    if (yals->pick == PSEUDO_BFS_CLAUSE_PICKING) {
+    if (pick == PSEUDO_BFS_CLAUSE_PICKING) {
       cpos = yals->stats.flips % nunsat;
     } else {
-      assert (yals->pick == RANDOM_CLAUSE_PICKING);
+      assert (pick == RANDOM_CLAUSE_PICKING);
       cpos = yals_rand_mod (yals, nunsat);
     }
     cidx = PEEK (yals->unsat.stack, cpos);
@@ -1265,6 +1731,22 @@ static unsigned yals_compute_weighted_break (Yals * yals, int lit) {
   return wb;
 }*/
 
+static unsigned yals_dynamic_iweighted_break (Yals * yals, int lit) {
+  unsigned res = yals_iweighted_break (yals, -lit);
+  res += yals_ixweighted_break (yals, ABS (lit));
+  LOG ("literal %d results in fixed-point weighted break %u", lit, res);
+  return res;
+}
+
+static unsigned yals_determine_iweighted_break (Yals * yals, int lit) {
+  unsigned res = yals_dynamic_iweighted_break (yals, lit);
+#ifndef NYALSTATS
+  if (yals->stats.wb.max < res/100) yals->stats.wb.max = res/100;
+  if (yals->stats.wb.min > res/100) yals->stats.wb.min = res/100;
+#endif
+  return res;
+}
+
 static float yals_determine_weighted_break (Yals * yals, int lit) {
   float res;
   //if (yals->crit)
@@ -1309,6 +1791,56 @@ yals_compute_score_from_weighted_break (Yals * yals, float w) {
   return s;
 }
 
+#ifdef YALS_AVX2
+
+// Computes the same scores as 'yals_compute_score_from_weighted_break' for
+// four weighted breaks at a time, using masked gathers for both table
+// lookups.  Returns the number of scores computed, a multiple of four.
+// Scores are summed up sequentially in 'yals_pick_by_score' to keep the
+// search independent of whether this function is used.
+
+__attribute__ ((target ("avx2")))
+static unsigned
+yals_compute_scores_avx2 (Yals * yals,
+  const float * wbs, double * scores, unsigned n) {
+  const double * cb = yals->exp.table.cb.start;
+  const double * two = yals->exp.table.two.start;
+  const __m128 maxcb = _mm_set1_ps ((float) yals->exp.max.cb);
+  const __m128i maxtwo = _mm_set1_epi32 ((int) yals->exp.max.two);
+  const __m128i minusone = _mm_set1_epi32 (-1);
+  const __m256d epscb = _mm256_set1_pd (yals->exp.eps.cb);
+  const __m256d epstwo = _mm256_set1_pd (yals->exp.eps.two);
+  const __m128 hundred = _mm_set1_ps (100.0f);
+  unsigned i;
+  for (i = 0; i + 4 <= n; i += 4) {
+    __m128 w = _mm_loadu_ps (wbs + i);
+    __m128i hi = _mm_cvttps_epi32 (w);
+    __m128 frac = _mm_mul_ps (_mm_sub_ps (w, _mm_cvtepi32_ps (hi)), hundred);
+    __m128i lo = _mm_cvttps_epi32 (frac);
+    __m128i inhi = _mm_castps_si128 (_mm_cmplt_ps (w, maxcb));
+    __m128i inlo = _mm_and_si128 (_mm_cmplt_epi32 (lo, maxtwo),
+                                  _mm_cmpgt_epi32 (lo, minusone));
+    __m256d shi = _mm256_mask_i32gather_pd (epscb, cb, hi,
+      _mm256_castsi256_pd (_mm256_cvtepi32_epi64 (inhi)), 8);
+    __m256d slo = _mm256_mask_i32gather_pd (epstwo, two, lo,
+      _mm256_castsi256_pd (_mm256_cvtepi32_epi64 (inlo)), 8);
+    _mm256_storeu_pd (scores + i, _mm256_mul_pd (shi, slo));
+  }
+  return i;
+}
+
+#endif
+
+// With fixed-point weights the score is a single table lookup.
+
+static double
+yals_compute_score_from_iweighted_break (Yals * yals, unsigned w) {
+  double s = (w < yals->exp.max.fixed) ?
+    PEEK (yals->exp.table.fixed, w) : yals->exp.eps.fixed;
+  LOG ("fixed-point weighted break %u gives score %g", w, s);
+  return s;
+}
+
 static int yals_pick_by_score (Yals * yals) {
   double s, lim, sum;
   const double * q;
@@ -1347,43 +1879,57 @@ static int yals_pick_by_score (Yals * yals) {
 
 static int yals_pick_literal (Yals * yals, int cidx) {
   const int pick_break_zero = yals->opts.breakzero.val;
+  const int fixed = (yals->usecrit == CRIT_FIXED);
+  const Word * frozen = yals->frozen;
   const int * p, * lits;
   int lit, zero;
-  float w;
+  unsigned iw = 0;
+  float w = 0;
   double s;
 
   assert (EMPTY (yals->breaks));
   assert (EMPTY (yals->cands));
+  assert (EMPTY (yals->scores));
 
   zero = 0;
 
-  // Gather candidates for flipping together with break(..) values
+  // Gather candidates for flipping together with break(..) values.  With
+  // fixed-point weights the scores are looked up right away.  Assumed
+  // variables are never flipped.
   if (cidx >= yals->nclauses) { // XOR clause
     lits = yals_xlits(yals, cidx - yals->nclauses);
     for (p = lits; (lit = *p); p++) {
+      if (frozen && GETBIT (frozen, yals->nvarwords, lit)) continue;
       // The literal to be flipped is always assumed to be false in the assignment
       if (yals_val(yals, lit)) lit = -lit;
-      w = yals_determine_weighted_break(yals, lit);
+      if (fixed) iw = yals_determine_iweighted_break (yals, lit);
+      else w = yals_determine_weighted_break(yals, lit);
 
-      LOG("literal %d weighted break %f", lit, w);
-      if (pick_break_zero && !w) {
-        if (!zero++) CLEAR (yals->cands);
+      LOG("literal %d weighted break %f", lit, fixed ? iw/100.0 : w);
+      if (pick_break_zero && (fixed ? !iw : !w)) {
+        if (!zero++) { CLEAR (yals->cands); CLEAR (yals->scores); }
         PUSH (yals->cands, lit);
       } else if (!zero) {
-        PUSH (yals->breaks, w);
+        if (fixed)
+          PUSH (yals->scores, yals_compute_score_from_iweighted_break (yals, iw));
+        else PUSH (yals->breaks, w);
         PUSH (yals->cands, lit);
       }
     }
   } else { // OR clause
     lits = yals_lits (yals, cidx);
     for (p = lits; (lit = *p); p++) {
-      w = yals_determine_weighted_break (yals, lit);
-      LOG ("literal %d weighted break %f", lit, w);
-      if (pick_break_zero && !w) {
-        if (!zero++) CLEAR (yals->cands);
+      if (frozen && GETBIT (frozen, yals->nvarwords, ABS (lit))) continue;
+      if (fixed) iw = yals_determine_iweighted_break (yals, lit);
+      else w = yals_determine_weighted_break (yals, lit);
+      LOG ("literal %d weighted break %f", lit, fixed ? iw/100.0 : w);
+      if (pick_break_zero && (fixed ? !iw : !w)) {
+        if (!zero++) { CLEAR (yals->cands); CLEAR (yals->scores); }
         PUSH (yals->cands, lit);
       } else if (!zero) {
-        PUSH (yals->breaks, w);
+        if (fixed)
+          PUSH (yals->scores, yals_compute_score_from_iweighted_break (yals, iw));
+        else PUSH (yals->breaks, w);
         PUSH (yals->cands, lit);
       }
     }
@@ -1402,9 +1948,18 @@ static int yals_pick_literal (Yals * yals, int cidx) {
     const unsigned n = COUNT (yals->breaks);
     unsigned i;
 
-    assert (EMPTY (yals->scores));
+    assert (fixed || EMPTY (yals->scores));
+    assert (!fixed || !n);
 
-    for (i = 0; i < n; i++) {
+    i = 0;
+#ifdef YALS_AVX2
+    if (yals->avx2 && n >= 4) {
+      while (SIZE (yals->scores) < n) ENLARGE (yals->scores);
+      i = yals_compute_scores_avx2 (yals, wbs, yals->scores.start, n);
+      yals->scores.top = yals->scores.start + i;
+    }
+#endif
+    for (; i < n; i++) {
       w = wbs[i];
       s = yals_compute_score_from_weighted_break (yals, w);
       LOG ("literal %d weighted break %f score %g", lits[i], w, s);
@@ -1588,7 +2143,9 @@ static void yals_dequeue_stack (Yals * yals, int cidx) {
   yals->pos[cidx] = -1;
 }
 
-static void yals_dequeue (Yals * yals, int cidx) {
+static YALS_INLINE void
+yals_dequeue_kernel (Yals * yals, int cidx, const int usequeue) {
+  assert (usequeue == yals->unsat.usequeue);
   if (cidx >= yals->nclauses) { // XOR clause
     LOG ("dequeue XOR %d", cidx - yals->nclauses);
     assert_valid_xcidx(cidx - yals->nclauses);
@@ -1596,8 +2153,9 @@ static void yals_dequeue (Yals * yals, int cidx) {
     LOG ("dequeue OR %d", cidx);
     assert_valid_cidx (cidx);
   }
-  if (yals->unsat.usequeue) yals_dequeue_queue (yals, cidx);
-  else yals_dequeue_stack (yals, cidx);
+  if (!usequeue) yals_dequeue_stack (yals, cidx);
+  else if (yals->unsat.usedeque) yals_dequeue_deque (yals, cidx);
+  else yals_dequeue_queue (yals, cidx);
 }
 
 static void yals_new_chunk (Yals * yals) {
@@ -1666,7 +2224,9 @@ static void yals_enqueue_stack (Yals * yals, int cidx) {
     yals->stats.maxstacksize = size;
 }
 
-static void yals_enqueue (Yals * yals, int cidx) {
+static YALS_INLINE void
+yals_enqueue_kernel (Yals * yals, int cidx, const int usequeue) {
+  assert (usequeue == yals->unsat.usequeue);
   if (cidx >= yals->nclauses) { // XOR clause
     LOG ("enqueue XOR %d", cidx - yals->nclauses);
     assert_valid_xcidx(cidx - yals->nclauses);
@@ -1675,8 +2235,13 @@ static void yals_enqueue (Yals * yals, int cidx) {
     assert_valid_cidx (cidx);
   }
 
-  if (yals->unsat.usequeue) yals_enqueue_queue (yals, cidx);
-  else yals_enqueue_stack (yals, cidx);
+  if (!usequeue) yals_enqueue_stack (yals, cidx);
+  else if (yals->unsat.usedeque) yals_enqueue_deque (yals, cidx);
+  else yals_enqueue_queue (yals, cidx);
+}
+
+static void yals_enqueue (Yals * yals, int cidx) {
+  yals_enqueue_kernel (yals, cidx, yals->unsat.usequeue);
 }
 
 static void yals_reset_unsat_stack (Yals * yals) {
@@ -1694,13 +2259,17 @@ static void yals_reset_unsat_stack (Yals * yals) {
 }
 
 static void yals_reset_unsat (Yals * yals) {
-  if (yals->unsat.usequeue) yals_reset_unsat_queue (yals);
+  if (yals->unsat.usedeque) yals_reset_unsat_deque (yals);
+  else if (yals->unsat.usequeue) yals_reset_unsat_queue (yals);
   else yals_reset_unsat_stack (yals);
 }
 
 /*------------------------------------------------------------------------*/
 
-static void yals_make_clauses_after_flipping_lit (Yals * yals, int lit) {
+static YALS_INLINE void
+yals_make_clauses_after_flipping_lit (Yals * yals, int lit,
+  const int satcntbytes, const int recs, const int crit, const int wide,
+  const int usequeue) {
   const int * p, * occs;
   int cidx, len, occ;
 #if !defined(NDEBUG) || !defined(NYALSTATS)
@@ -1709,10 +2278,11 @@ static void yals_make_clauses_after_flipping_lit (Yals * yals, int lit) {
   assert (yals_val (yals, lit));
   occs = yals_occs (yals, lit);
   for (p = occs; (occ = *p) >= 0; p++) {
-    len = occ & LENMASK;
-    cidx = occ >> LENSHIFT;
-    if (yals_incsatcnt (yals, cidx, lit, len)) continue;
-    yals_dequeue (yals, cidx);
+    len = (recs || !crit) ? 0 : yals_occ_len (yals, occ, wide);
+    cidx = yals_occ_cidx (occ, wide);
+    if (yals_incsatcnt (yals, cidx, lit, len, satcntbytes, recs, crit))
+      continue;
+    yals_dequeue_kernel (yals, cidx, usequeue);
     LOGCIDX (cidx, "made");
 #if !defined(NDEBUG) || !defined(NYALSTATS)
     made++;
@@ -1724,7 +2294,7 @@ static void yals_make_clauses_after_flipping_lit (Yals * yals, int lit) {
   {
     int updated = p - occs;
     ADD (update, updated);
-    if (yals->crit) ADD (crit, updated);
+    if (crit) ADD (crit, updated);
   }
 #endif
 #ifndef NYALSTATS
@@ -1732,7 +2302,10 @@ static void yals_make_clauses_after_flipping_lit (Yals * yals, int lit) {
 #endif
 }
 
-static void yals_break_clauses_after_flipping_lit (Yals * yals, int lit) {
+static YALS_INLINE void
+yals_break_clauses_after_flipping_lit (Yals * yals, int lit,
+  const int satcntbytes, const int recs, const int crit, const int wide,
+  const int usequeue) {
   const int * p, * occs;
   int occ, cidx, len;
 #if !defined(NDEBUG) || !defined(NYALSTATS)
@@ -1740,10 +2313,11 @@ static void yals_break_clauses_after_flipping_lit (Yals * yals, int lit) {
 #endif
   occs = yals_occs (yals, -lit);
   for (p = occs; (occ = *p) >= 0; p++) {
-    len = occ & LENMASK;
-    cidx = occ >> LENSHIFT;
-    if (yals_decsatcnt (yals, cidx, -lit, len)) continue;
-    yals_enqueue (yals, cidx);
+    len = (recs || !crit) ? 0 : yals_occ_len (yals, occ, wide);
+    cidx = yals_occ_cidx (occ, wide);
+    if (yals_decsatcnt (yals, cidx, -lit, len, satcntbytes, recs, crit))
+      continue;
+    yals_enqueue_kernel (yals, cidx, usequeue);
     LOGCIDX (cidx, "broken");
 #if !defined(NDEBUG) || !defined(NYALSTATS)
     broken++;
@@ -1755,7 +2329,7 @@ static void yals_break_clauses_after_flipping_lit (Yals * yals, int lit) {
   {
     int updated = p - occs;
     ADD (update, updated);
-    if (yals->crit) ADD (crit, updated);
+    if (crit) ADD (crit, updated);
   }
 #endif
 #ifndef NYALSTATS
@@ -1766,7 +2340,7 @@ static void yals_break_clauses_after_flipping_lit (Yals * yals, int lit) {
 static void yals_check_xweighted_breaks(Yals * yals) {
 #ifndef NDEBUG
   if (!yals->opts.checking.val) return;
-  if (!yals->crit) return;
+  if (!yals->usecrit) return;
 
   float d, f, w1, w2, xw;
   for (int lit = 1; lit < yals->nvars; lit++) {
@@ -1788,7 +2362,9 @@ static void yals_check_xweighted_breaks(Yals * yals) {
 #endif
 }
 
-static void yals_flip_xclauses_after_flipping_lit(Yals * yals, int lit) {
+static YALS_INLINE void
+yals_flip_xclauses_after_flipping_lit (Yals * yals, int lit,
+  const int crit, const int wide, const int usequeue) {
   const int * p, * occs, * q;
   int cidx, occ;
   int tmp_lit;
@@ -1802,24 +2378,24 @@ static void yals_flip_xclauses_after_flipping_lit(Yals * yals, int lit) {
   // to compute made, broken
   occs = yals_xoccs (yals, ABS(lit));
   for (p = occs; (occ = *p) >= 0; p++) {
-    cidx = occ >> LENSHIFT;
+    cidx = yals_occ_cidx (occ, wide);
     if (yals_flipxorsat(yals, cidx)) {
-      yals_dequeue(yals, yals->nclauses + cidx);
+      yals_dequeue_kernel (yals, yals->nclauses + cidx, usequeue);
       LOGCIDX (yals->nclauses + cidx, "made");
-      if (yals->crit) {
+      if (crit) {
         for (q = yals_xlits(yals, cidx); (tmp_lit = *q); q++) {
-          yals_inc_xweighted_break(yals, tmp_lit, yals->xorweight);
+          yals_inc_xor_break (yals, tmp_lit, crit);
         }
       }
 #if !defined(NDEBUG) || !defined(NYALSTATS)
       made++;
 #endif
     } else {
-      yals_enqueue(yals, yals->nclauses + cidx);
+      yals_enqueue_kernel (yals, yals->nclauses + cidx, usequeue);
       LOGCIDX (yals->nclauses + cidx, "broken");
-      if (yals->crit) {
+      if (crit) {
         for (q = yals_xlits(yals, cidx); (tmp_lit = *q); q++) {
-          yals_dec_xweighted_break(yals, tmp_lit, yals->xorweight);
+          yals_dec_xor_break (yals, tmp_lit, crit);
         }
       }
 #if !defined(NDEBUG) || !defined(NYALSTATS)
@@ -1832,7 +2408,7 @@ static void yals_flip_xclauses_after_flipping_lit(Yals * yals, int lit) {
   {
     int updated = p - occs;
     ADD (update, updated);
-    if (yals->crit) ADD (crit, updated);
+    if (crit) ADD (crit, updated);
   }
 #endif
 
@@ -1850,18 +2426,87 @@ static void yals_update_minimum (Yals * yals) {
   yals_check_global_invariant (yals);
 }
 
-static void yals_flip (Yals * yals) {
-  int cidx = yals_pick_clause (yals);
+static YALS_INLINE void
+yals_flip_kernel (Yals * yals, const int satcntbytes, const int recs,
+  const int wide, const int crit, const int pick) {
+  const int usequeue = (pick > 0);
+  int cidx = yals_pick_clause (yals, pick);
   int lit = yals_pick_literal (yals, cidx);
   yals->stats.flips++;
-  yals->stats.unsum += yals_nunsat (yals);
+  yals->stats.unsum += yals_nunsat_kernel (yals, usequeue);
   yals_flip_value_of_lit (yals, lit);
-  yals_make_clauses_after_flipping_lit (yals, lit);
-  yals_break_clauses_after_flipping_lit (yals, lit);
-  yals_flip_xclauses_after_flipping_lit (yals, lit);
+  assert (wide == yals->wideoccs);
+  yals_make_clauses_after_flipping_lit (yals, lit,
+    satcntbytes, recs, crit, wide, usequeue);
+  yals_break_clauses_after_flipping_lit (yals, lit,
+    satcntbytes, recs, crit, wide, usequeue);
+  yals_flip_xclauses_after_flipping_lit (yals, lit, crit, wide, usequeue);
   yals_update_minimum (yals);
 }
 
+// Generic flip with all configuration checks done at run-time.
+
+static void yals_flip_generic (Yals * yals) {
+  yals_flip_kernel (yals,
+    yals->satcntbytes, yals->recs != 0, yals->wideoccs,
+    yals->usecrit, yals->pick);
+}
+
+// Instantiates one specialized flip kernel for each combination of the
+// clause data layout (number of bytes per satisfied literal counter or
+// per-clause records) and whether critical literals are used (and with
+// which weights).  These decide the branches taken for every occurrence
+// of the flipped literal.  Wide occurrences and the clause picking
+// strategy are checked at run-time, since specializing them as well did
+// not measurably improve the flip rate but multiplied the code size.  One
+// kernel is selected once in 'yals_select_flip_kernel' (at the end of
+// 'yals_connect') and called through 'yals->flip' by 'yals_inner_loop'.
+
+#define FLIPKERNELSTEMPLATE \
+  FLIPKERNELLAYOUT (1, 1, 0) \
+  FLIPKERNELLAYOUT (2, 2, 0) \
+  FLIPKERNELLAYOUT (4, 4, 0) \
+  FLIPKERNELLAYOUT (rec, 4, 1)
+
+#define FLIPKERNELLAYOUT(LAYOUT,SATCNTBYTES,RECS) \
+  FLIPKERNEL (LAYOUT, SATCNTBYTES, RECS, 0) \
+  FLIPKERNEL (LAYOUT, SATCNTBYTES, RECS, 1) \
+  FLIPKERNEL (LAYOUT, SATCNTBYTES, RECS, 2)
+
+#define DEFFLIPKERNEL(LAYOUT,SATCNTBYTES,RECS,CRIT) \
+static void yals_flip_ ## LAYOUT ## _ ## CRIT (Yals * yals) { \
+  yals_flip_kernel (yals, (SATCNTBYTES), (RECS), yals->wideoccs, (CRIT), \
+    yals->pick); \
+}
+
+#define FLIPKERNEL DEFFLIPKERNEL
+FLIPKERNELSTEMPLATE
+#undef FLIPKERNEL
+
+#define SELECTFLIPKERNEL(LAYOUT,SATCNTBYTES,RECS,CRIT) \
+do { \
+  if (yals->satcntbytes != (SATCNTBYTES)) break; \
+  if ((yals->recs != 0) != (RECS)) break; \
+  if (yals->usecrit != (CRIT)) break; \
+  yals->flip = yals_flip_ ## LAYOUT ## _ ## CRIT; \
+  yals_msg (yals, 1, \
+    "using specialized flip kernel '%s'", \
+    "yals_flip_" #LAYOUT "_" #CRIT); \
+  return; \
+} while (0);
+
+#define FLIPKERNEL SELECTFLIPKERNEL
+
+static void yals_select_flip_kernel (Yals * yals) {
+  if (yals->opts.kernel.val) {
+    FLIPKERNELSTEMPLATE
+  }
+  yals->flip = yals_flip_generic;
+  yals_msg (yals, 1, "using generic flip");
+}
+
+#undef FLIPKERNEL
+
 /*------------------------------------------------------------------------*/
 
 // Preprocess the formula via unit propagation
@@ -1984,7 +2629,7 @@ static void yals_preprocess (Yals * yals) {
   int cidx = 0;
   int ccidx = 0;
   for (c = q; c < yals->xcdb.top; c++) {
-    satisfied = PEEK(yals->xparitydb, cidx);
+    satisfied = yals_xparity (yals, cidx);
     int hasBlank = 0;
     for (p = c; (lit = *p); p++) {
       if (!vals[lit]) {
@@ -2005,14 +2650,14 @@ static void yals_preprocess (Yals * yals) {
       for (p = c; (lit = *p); p++) {
         if (vals[lit] != 0) { // `lit` was assigned, flip parity if 1 and remove it from clause
           if (vals[lit] > 0) {
-            POKE(yals->xparitydb, cidx, PEEK(yals->xparitydb, cidx) ^ 1);
+            yals_setxparity (yals, cidx, !yals_xparity (yals, cidx));
           }
           nstr++;
           continue;
         }
         *q++ = lit;
       }
-      POKE(yals->xparitydb, ccidx, PEEK(yals->xparitydb, cidx));
+      yals_setxparity (yals, ccidx, yals_xparity (yals, cidx));
       ccidx++;
       assert (q >= yals->xcdb.start + 1);
       assert (q[-1]);
@@ -2023,9 +2668,13 @@ static void yals_preprocess (Yals * yals) {
   }
   yals->xcdb.top = q;
   FIT (yals->xcdb);
-  yals->xparitydb.top = yals->xparitydb.start + ccidx;
+  yals->nxparities = ccidx;
+  yals->xparitydb.top =
+    yals->xparitydb.start + (ccidx + BITS_PER_WORD - 1) / BITS_PER_WORD;
+  if (ccidx & BITMAPMASK)
+    yals->xparitydb.top[-1] &= BIT (ccidx) - 1;
   FIT (yals->xparitydb);
-  assert(COUNT (yals->xparitydb) == cidx - xnsat);
+  assert(yals->nxparities == cidx - xnsat);
   newnlits += COUNT(yals->xcdb);
   assert(newnlits <= oldnlits);
 
@@ -2057,70 +2706,254 @@ static Word yals_primes[] = {
 
 #define NPRIMES (sizeof(yals_primes)/sizeof(unsigned))
 
-static Word yals_sig (Yals * yals) {
+static Word yals_sig_of (Yals * yals, const Word * vals) {
   unsigned i = 0, j;
   Word res = 0;
   for (j = 0; j < yals->nvarwords; j++) {
-    res += yals_primes[i++] * yals->vals[j];
+    res += yals_primes[i++] * vals[j];
     if (i == NPRIMES) i = 0;
   }
   return res;
 }
 
-static unsigned yals_gcd (unsigned a, unsigned b) {
-  while (b) {
-    unsigned r = a % b;
-    a = b, b = r;
+// Cache positions plus one are indexed by their signature in the open
+// addressing hash table 'cachehash' with linear probing.  The positions
+// are also kept in the max-heap 'cacheheap' ordered by their minimum with
+// 'cacheheappos' mapping positions back to the heap.  Minima of cached
+// assignments only decrease, thus the smallest is tracked in 'cachebest'.
+// Signatures are Fibonacci hashed, i.e., the top bits of the product are
+// used, since the low bits only depend on the low bits of the signature.
+
+static unsigned yals_cache_hash (Yals * yals, Word sig) {
+  const int ld = yals_ctz (yals->cachehashsize);
+  return ((uint64_t) sig * 0x9e3779b97f4a7c15ull) >> (64 - ld);
+}
+
+static void yals_cache_hash_insert (Yals * yals, int pos) {
+  unsigned h = yals_cache_hash (yals, PEEK (yals->sigs, pos));
+  while (yals->cachehash[h]) h = (h + 1) & (yals->cachehashsize - 1);
+  yals->cachehash[h] = pos + 1;
+}
+
+static void yals_cache_hash_enlarge (Yals * yals) {
+  int i, size = yals->cachehashsize, ncache = COUNT (yals->cache);
+  if (2*(ncache + 1) <= size) return;
+  DELN (yals->cachehash, size);
+  yals->cachehashsize = size ? 2*size : 16;
+  while (2*(ncache + 1) > yals->cachehashsize) yals->cachehashsize *= 2;
+  NEWN (yals->cachehash, yals->cachehashsize);
+  for (i = 0; i < ncache; i++) yals_cache_hash_insert (yals, i);
+}
+
+// Deletion shifts back later entries of the same probe sequence.
+
+static void yals_cache_hash_remove (Yals * yals, int pos) {
+  const unsigned mask = yals->cachehashsize - 1;
+  unsigned h = yals_cache_hash (yals, PEEK (yals->sigs, pos)), i, home;
+  while (yals->cachehash[h] != pos + 1) h = (h + 1) & mask;
+  for (i = (h + 1) & mask; yals->cachehash[i]; i = (i + 1) & mask) {
+    home = yals_cache_hash (yals, PEEK (yals->sigs, yals->cachehash[i] - 1));
+    if (((i - home) & mask) < ((i - h) & mask)) continue;
+    yals->cachehash[h] = yals->cachehash[i];
+    h = i;
+  }
+  yals->cachehash[h] = 0;
+}
+
+// Cached assignments are stored as byte strings.  With 'cachecompress'
+// the first byte is one and is followed by the distances between the
+// differing bits of the assignment and the reference assignment
+// 'cacheref' (the first encoded one) as variable length integers.
+// Otherwise, or if that is not smaller, the first byte is zero and is
+// followed by a verbatim copy.  Encodings are unique and thus can be
+// compared directly to detect duplicates.
+
+static void yals_cache_encode (Yals * yals, const Word * vals) {
+  const size_t bytes = yals->nvarwords * sizeof (Word);
+  unsigned idx, last = 0, delta;
+  Word diff;
+  int i;
+  CLEAR (yals->cachebuf);
+  if (!yals->opts.cachecompress.val) goto COPY;
+  if (!yals->cacheref) {
+    NEWN (yals->cacheref, yals->nvarwords);
+    memcpy (yals->cacheref, vals, bytes);
+  }
+  PUSH (yals->cachebuf, 1);
+  for (i = 0; i < yals->nvarwords; i++) {
+    for (diff = vals[i] ^ yals->cacheref[i]; diff; diff &= diff - 1) {
+      idx = i * BITS_PER_WORD + yals_ctz (diff);
+      delta = idx - last, last = idx;
+      while (delta >= 0x80) {
+	PUSH (yals->cachebuf, (delta & 0x7f) | 0x80);
+	delta >>= 7;
+      }
+      PUSH (yals->cachebuf, delta);
+      if ((size_t) COUNT (yals->cachebuf) > bytes) goto COPY;
+    }
+  }
+  return;
+COPY:
+  CLEAR (yals->cachebuf);
+  PUSH (yals->cachebuf, 0);
+  while ((size_t) SIZE (yals->cachebuf) < bytes + 1)
+    ENLARGE (yals->cachebuf);
+  RESET (yals->cachebuf, bytes + 1);
+  memcpy (yals->cachebuf.start + 1, vals, bytes);
+}
+
+static void yals_cache_decode (Yals * yals, int pos, Word * vals) {
+  const size_t bytes = yals->nvarwords * sizeof (Word);
+  const unsigned char * p = PEEK (yals->cache, pos), * end;
+  unsigned idx = 0, delta, shift;
+  end = p + PEEK (yals->cachesizes, pos);
+  if (!*p++) { memcpy (vals, p, bytes); return; }
+  memcpy (vals, yals->cacheref, bytes);
+  while (p < end) {
+    delta = shift = 0;
+    do delta |= (*p & 0x7f) << shift, shift += 7;
+    while (*p++ & 0x80);
+    idx += delta;
+    NOTBIT (vals, yals->nvarwords, (int) idx);
   }
-  return a;
 }
 
-static void yals_cache_assignment (Yals * yals) {
-  int min, other_min, cachemax, cachemin, cachemincount, cachemaxcount;
-  unsigned start, delta, i, j, ncache, rpos;
-  Word sig, other_sig, * other_vals;
-  size_t bytes;
-#ifndef NDEBUG
-  int count;
-#endif
+static void yals_cache_store (Yals * yals, int pos) {
+  int size = COUNT (yals->cachebuf);
+  unsigned char * other;
+  NEWN (other, size);
+  memcpy (other, yals->cachebuf.start, size);
+  if (pos < COUNT (yals->cache)) {
+    DELN (PEEK (yals->cache, pos), PEEK (yals->cachesizes, pos));
+    POKE (yals->cache, pos, other);
+    POKE (yals->cachesizes, pos, size);
+  } else {
+    PUSH (yals->cache, other);
+    PUSH (yals->cachesizes, size);
+  }
+}
 
-  if (!yals->opts.cachemin.val) return;
-  sig = yals_sig (yals);
-  ncache = COUNT (yals->cache);
-  for (i = 0; i < ncache; i++) {
-    other_sig = PEEK (yals->sigs, i);
+// Looks up the assignment just encoded in 'cachebuf'.
+
+static int yals_cache_find (Yals * yals, Word sig) {
+  const int size = COUNT (yals->cachebuf);
+  unsigned h;
+  int pos;
+  if (!yals->cachehashsize) return -1;
+  for (h = yals_cache_hash (yals, sig);
+       (pos = yals->cachehash[h]);
+       h = (h + 1) & (yals->cachehashsize - 1)) {
     yals->stats.sig.search++;
-    if (other_sig != sig) { yals->stats.sig.neg++; continue; }
-    other_vals = PEEK (yals->cache, i);
-    for (j = 0; j < yals->nvarwords; j++)
-      if (other_vals[j] != yals->tmp[j]) break;
-    if (j == yals->nvarwords) {
-      yals_msg (yals, 2, "current assigment already in cache");
-      yals->stats.cache.skipped++;
+    if (PEEK (yals->sigs, pos - 1) != sig) { yals->stats.sig.neg++; continue; }
+    if (PEEK (yals->cachesizes, pos - 1) == size &&
+        !memcmp (PEEK (yals->cache, pos - 1), yals->cachebuf.start, size)) {
       yals->stats.sig.truepos++;
-      return;
+      return pos - 1;
     }
     yals->stats.sig.falsepos++;
   }
+  return -1;
+}
 
-  cachemin = INT_MAX, cachemax = -1;
-  cachemaxcount = cachemincount = 0;
-  for (j = 0; j < ncache; j++) {
-    other_min = PEEK (yals->mins, j);
-    if (other_min < cachemin) cachemin = other_min, cachemincount = 0;
-    if (other_min > cachemax) cachemax = other_min, cachemaxcount = 0;
-    if (other_min == cachemin) cachemincount++;
-    if (other_min == cachemax) cachemaxcount++;
+static int yals_cache_heap_min (Yals * yals, int i) {
+  return PEEK (yals->mins, PEEK (yals->cacheheap, i));
+}
+
+static void yals_cache_heap_set (Yals * yals, int i, int pos) {
+  POKE (yals->cacheheap, i, pos);
+  POKE (yals->cacheheappos, pos, i);
+}
+
+static void yals_cache_heap_up (Yals * yals, int i) {
+  int pos = PEEK (yals->cacheheap, i), min = PEEK (yals->mins, pos), p;
+  while (i > 0 && yals_cache_heap_min (yals, (p = (i - 1)/2)) < min) {
+    yals_cache_heap_set (yals, i, PEEK (yals->cacheheap, p));
+    i = p;
+  }
+  yals_cache_heap_set (yals, i, pos);
+}
+
+static void yals_cache_heap_down (Yals * yals, int i) {
+  int pos = PEEK (yals->cacheheap, i), min = PEEK (yals->mins, pos), c;
+  int n = COUNT (yals->cacheheap);
+  while ((c = 2*i + 1) < n) {
+    if (c + 1 < n && yals_cache_heap_min (yals, c + 1) >
+                     yals_cache_heap_min (yals, c)) c++;
+    if (yals_cache_heap_min (yals, c) <= min) break;
+    yals_cache_heap_set (yals, i, PEEK (yals->cacheheap, c));
+    i = c;
+  }
+  yals_cache_heap_set (yals, i, pos);
+}
+
+// Position of a cached assignment with the largest minimum.
+
+static int yals_cache_worst (Yals * yals) {
+  assert (!EMPTY (yals->cacheheap));
+  return PEEK (yals->cacheheap, 0);
+}
+
+static void yals_cache_push (Yals * yals, Word sig, int min) {
+  int pos = COUNT (yals->cache);
+  yals_cache_hash_enlarge (yals);
+  yals_cache_store (yals, pos);
+  PUSH (yals->sigs, sig);
+  PUSH (yals->mins, min);
+  PUSH (yals->cacheheap, pos);
+  PUSH (yals->cacheheappos, COUNT (yals->cacheheap) - 1);
+  yals_cache_heap_up (yals, COUNT (yals->cacheheap) - 1);
+  yals_cache_hash_insert (yals, pos);
+  if (min < yals->cachebest) yals->cachebest = min;
+}
+
+// Overwrites the cached assignment at 'pos' with a smaller minimum.
+
+static void yals_cache_replace (Yals * yals, int pos, Word sig, int min) {
+  assert (min <= PEEK (yals->mins, pos));
+  yals_cache_hash_remove (yals, pos);
+  yals_cache_store (yals, pos);
+  POKE (yals->sigs, pos, sig);
+  POKE (yals->mins, pos, min);
+  yals_cache_heap_down (yals, PEEK (yals->cacheheappos, pos));
+  yals_cache_hash_insert (yals, pos);
+  if (min < yals->cachebest) yals->cachebest = min;
+}
+
+static void yals_cache_assignment (Yals * yals) {
+  int min, cachemax, cachemin, cachemincount, cachemaxcount, ncache, rpos;
+  int j, other_min;
+  Word sig;
+
+  if (!yals->opts.cachemin.val) return;
+  sig = yals_sig_of (yals, yals->tmp);
+  yals_cache_encode (yals, yals->tmp);
+  if (yals_cache_find (yals, sig) >= 0) {
+    yals_msg (yals, 2, "current assigment already in cache");
+    yals->stats.cache.skipped++;
+    return;
+  }
+
+  ncache = COUNT (yals->cache);
+  if (ncache) {
+    cachemin = yals->cachebest;
+    cachemax = PEEK (yals->mins, yals_cache_worst (yals));
+  } else cachemin = INT_MAX, cachemax = -1;
+  if (yals->opts.verbose.val >= 2) {
+    cachemaxcount = cachemincount = 0;
+    for (j = 0; j < ncache; j++) {
+      other_min = PEEK (yals->mins, j);
+      if (other_min == cachemin) cachemincount++;
+      if (other_min == cachemax) cachemaxcount++;
+    }
+    yals_msg (yals, 2,
+      "cache of size %d minimum %d (%d = %.0f%%) maximum %d (%d = %.0f%%)",
+      ncache,
+      cachemin, cachemincount, yals_pct (cachemincount, ncache),
+      cachemax, cachemaxcount, yals_pct (cachemaxcount, ncache));
   }
-  yals_msg (yals, 2,
-    "cache of size %d minimum %d (%d = %.0f%%) maximum %d (%d = %.0f%%)",
-    ncache,
-    cachemin, cachemincount, yals_pct (cachemincount, ncache),
-    cachemax, cachemaxcount, yals_pct (cachemaxcount, ncache));
 
   min = yals->stats.tmp;
   assert (min <= yals_nunsat (yals));
-  bytes = yals->nvarwords * sizeof (Word);
   if (!yals->cachesizetarget) {
     yals->cachesizetarget = yals->opts.cachemin.val;
     assert (yals->cachesizetarget);
@@ -2134,49 +2967,16 @@ PUSH_ASSIGNMENT:
     yals_msg (yals, 2,
       "pushing current assigment with minimum %d in cache as assignment %d",
       min, ncache);
-    NEWN (other_vals, yals->nvarwords);
-    memcpy (other_vals, yals->tmp, bytes);
-    PUSH (yals->cache, other_vals);
-    PUSH (yals->sigs, sig);
-    PUSH (yals->mins, min);
+    yals_cache_push (yals, sig, min);
     yals->stats.cache.inserted++;
   } else {
     assert (ncache == yals->cachesizetarget);
-    if (ncache == 1) start = delta = 0;
-    else {
-      start = yals_rand_mod (yals, ncache);
-      delta = yals_rand_mod (yals, ncache - 1) + 1;
-      while (yals_gcd (ncache, delta) != 1)
-        delta--;
-    }
-    rpos = ncache;
-    j = start;
-#ifndef NDEBUG
-    count = 0;
-#endif
-    do {
-      other_min = PEEK (yals->mins, j);
-      assert (other_min >= cachemin);
-      assert (other_min <= cachemax);
-      if (other_min == cachemax && other_min > min) rpos = j;
-      j += delta;
-      if (j >= ncache) j -= ncache, assert (j < ncache);
-#ifndef NDEBUG
-      count++;
-#endif
-    } while (j != start);
-    assert (count == ncache);
-
-    if (rpos < ncache) {
-      assert (min < cachemax);
-      assert (PEEK (yals->mins, rpos) == cachemax);
+    if (cachemax > min) {
+      rpos = yals_cache_worst (yals);
       yals_msg (yals, 2,
         "replacing cached %d (minimum %d) better minimum %d",
         rpos, cachemax, min);
-      other_vals = PEEK (yals->cache, rpos);
-      memcpy (other_vals, yals->tmp, bytes);
-      POKE (yals->mins, rpos, min);
-      POKE (yals->sigs, rpos, sig);
+      yals_cache_replace (yals, rpos, sig, min);
       yals->stats.cache.replaced++;
     } else if (min > cachemax ||
                (cachemin < cachemax && min == cachemax)) {
@@ -2204,11 +3004,79 @@ DO_NOT_CACHE_ASSSIGNEMNT:
   }
 }
 
-static void yals_remove_trailing_bits (Yals * yals) {
-  unsigned i;
-  Word mask;
-  if (!yals->nvarwords) return;
-  i = yals->nvars & BITMAPMASK;
+// Publishes the best assignment of this instance to the elite pool if it
+// is better than the worst pooled one and not pooled yet.  Writers never
+// wait for each other but give up if the slot is written concurrently.
+
+static void yals_publish_elite (Yals * yals) {
+  const size_t bytes = yals->nvarwords * sizeof (Word);
+  int i, min = yals->stats.best, worst = -1, worstmin = min, other;
+  unsigned seq;
+  Elite * e;
+  Word sig;
+
+  sig = yals_sig_of (yals, yals->best);
+  for (i = 0; i < yals->nelites; i++) {
+    e = yals->elites + i;
+    other = __atomic_load_n (&e->min, __ATOMIC_RELAXED);
+    if (other == min && __atomic_load_n (&e->sig, __ATOMIC_RELAXED) == sig)
+      return;
+    if (other > worstmin) worst = i, worstmin = other;
+  }
+  if (worst < 0) return;
+
+  e = yals->elites + worst;
+  seq = __atomic_load_n (&e->seq, __ATOMIC_RELAXED);
+  if ((seq & 1) ||
+      !__atomic_compare_exchange_n (&e->seq, &seq, seq + 1, 0,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+    yals->stats.elite.busy++;
+    return;
+  }
+  __atomic_thread_fence (__ATOMIC_RELEASE);
+  if (__atomic_load_n (&e->min, __ATOMIC_RELAXED) > min) {
+    memcpy (e->vals, yals->best, bytes);
+    __atomic_store_n (&e->sig, sig, __ATOMIC_RELAXED);
+    __atomic_store_n (&e->min, min, __ATOMIC_RELAXED);
+    yals->stats.elite.published++;
+    yals_msg (yals, 2,
+      "published best assignment with minimum %d as elite %d", min, worst);
+  }
+  __atomic_store_n (&e->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+// Copies the best pooled assignment to 'vals' if it is better than the
+// best assignment of this instance.  Returns its minimum or a negative
+// value if there is none or it was written while being copied.
+
+static int yals_pick_elite (Yals * yals) {
+  const size_t bytes = yals->nvarwords * sizeof (Word);
+  int i, min = yals->stats.best, best = -1, other;
+  unsigned seq;
+  Elite * e;
+
+  for (i = 0; i < yals->nelites; i++) {
+    other = __atomic_load_n (&yals->elites[i].min, __ATOMIC_RELAXED);
+    if (other < min) best = i, min = other;
+  }
+  if (best < 0) return -1;
+
+  e = yals->elites + best;
+  seq = __atomic_load_n (&e->seq, __ATOMIC_ACQUIRE);
+  if (!(seq & 1)) {
+    memcpy (yals->vals, e->vals, bytes);
+    __atomic_thread_fence (__ATOMIC_ACQUIRE);
+    if (__atomic_load_n (&e->seq, __ATOMIC_RELAXED) == seq) return min;
+  }
+  yals->stats.elite.torn++;
+  return -1;
+}
+
+static void yals_remove_trailing_bits (Yals * yals) {
+  unsigned i;
+  Word mask;
+  if (!yals->nvarwords) return;
+  i = yals->nvars & BITMAPMASK;
   mask = ((Word)1) << (i + 1);
   yals->vals[yals->nvarwords-1] &= mask - 1;
 }
@@ -2250,16 +3118,37 @@ static void yals_setphases (Yals * yals) {
 }
 
 static void yals_pick_assignment (Yals * yals, int initial) {
-  int idx, pos, neg, i, nvars = yals->nvars, ncache;
+  int idx, pos, neg, i, nvars = yals->nvars, ncache, min;
   size_t bytes = yals->nvarwords * sizeof (Word);
   const int vl = 1 + !initial;
   if (!initial && yals->opts.best.val) {
     yals->stats.pick.best++;
     yals_msg (yals, vl, "picking previous best assignment");
     memcpy (yals->vals, yals->best, bytes);
+  } else if (initial && yals->warm) {
+    yals->warm = 0;
+    yals->stats.pick.best++;
+    yals_msg (yals, vl, "picking best assignment of previous call");
+    memcpy (yals->vals, yals->best, bytes);
   } else if (!initial && yals->opts.keep.val) {
     yals->stats.pick.keep++;
     yals_msg (yals, vl, "picking current assignment (actually keeping it)");
+  } else if (!initial &&
+             yals->elites &&
+             (min = yals_pick_elite (yals)) >= 0) {
+    yals->stats.pick.elite++;
+    yals_msg (yals, vl, "picking elite assignment with minimum %d", min);
+  } else if (initial &&
+             yals->cacheloaded &&
+             (ncache = COUNT (yals->cache)) > 0) {
+    yals->cacheloaded = 0;
+    for (pos = 0, i = 1; i < ncache; i++)
+      if (PEEK (yals->mins, i) < PEEK (yals->mins, pos)) pos = i;
+    yals->stats.pick.cached++;
+    yals_msg (yals, vl,
+      "picking loaded cached assignment %d with minimum %d",
+      pos, PEEK (yals->mins, pos));
+    yals_cache_decode (yals, pos, yals->vals);
   } else if (!initial &&
              yals->strat.cached &&
              (ncache = COUNT (yals->cache)) > 0) {
@@ -2283,7 +3172,7 @@ static void yals_pick_assignment (Yals * yals, int initial) {
     yals_msg (yals, vl,
       "picking cached assignment %d with minimum %d",
       pos, PEEK (yals->mins, pos));
-    memcpy (yals->vals, PEEK (yals->cache, pos), bytes);
+    yals_cache_decode (yals, pos, yals->vals);
   } else if (yals->strat.pol < 0) {
     yals->stats.pick.neg++;
     yals_msg (yals, vl, "picking all negative assignment");
@@ -2321,53 +3210,62 @@ static void yals_log_assignment (Yals * yals) {
 #endif
 }
 
-static float yals_len_to_weight (Yals * yals, int len) {
+// Clause weights are given in hundredths.
+
+static unsigned yals_len_to_iweight (Yals * yals, int len) {
   // const int uni = yals->strat.uni;
   // const int weight = yals->strat.weight;
-  const float weight2 = (float)yals->opts.weight2.val / 100.0;
-  const float weight3 = (float)yals->opts.weight3.val / 100.0;
-  const float weight4 = (float)yals->opts.weight4.val / 100.0;
-  const float weight5 = (float)yals->opts.weight5.val / 100.0;
-  const float weight6 = (float)yals->opts.weight6.val / 100.0;
-  const float weight7 = (float)yals->opts.weight7.val / 100.0;
-  const float weight8 = (float)yals->opts.weight8.val / 100.0;
-  float w;
+  int w;
 
 //  if (uni > 0) w = weight;
 //  else if (uni < 0) w = MIN (len, weight);
 //  else w = MAX (weight - len, 1);
   if (len == 2)
-    w = weight2;
+    w = yals->opts.weight2.val;
   else if (len == 3)
-    w = weight3;
+    w = yals->opts.weight3.val;
   else if (len == 4)
-    w = weight4;
+    w = yals->opts.weight4.val;
   else if (len == 5)
-    w = weight5;
+    w = yals->opts.weight5.val;
   else if (len == 6)
-    w = weight6;
+    w = yals->opts.weight6.val;
   else if (len == 7)
-    w = weight7;
+    w = yals->opts.weight7.val;
   else
-    w = weight8;
+    w = yals->opts.weight8.val;
 
   return w;
 }
 
-static void yals_update_sat_and_unsat (Yals * yals) {
+static float yals_len_to_weight (Yals * yals, int len) {
+  const float w = (float) yals_len_to_iweight (yals, len) / 100.0;
+  return w;
+}
+
+// Value of the variables of the cidx-th XOR clause xor'ed together.  The
+// masked words are xor'ed first which preserves the parity of their sum.
+
+static int yals_xorval (Yals * yals, int cidx) {
+  const XMask * m, * end;
+  Word acc = 0;
+  assert_valid_xcidx (cidx);
+  m = yals->xmasks + yals->xmaskrefs[cidx];
+  end = yals->xmasks + yals->xmaskrefs[cidx + 1];
+  for (; m < end; m++)
+    acc ^= WORD (yals->vals, yals->nvarwords, m->word * BITS_PER_WORD) & m->mask;
+  return yals_popcount (acc) & 1;
+}
+
+// Computes satisfied counters, critical literals and weights of the OR
+// clauses starting at 'from' and adds them to the break values and
+// unsatisfied clauses.
+
+static void yals_init_clauses (Yals * yals, int from) {
   int lit, cidx, len, cappedlen, crit;
   const int * lits, * p;
   unsigned satcnt;
-  yals_log_assignment (yals);
-  yals_reset_unsat (yals);
-  for (len = 1; len <= MAXLEN; len++)
-    yals->weights[len] = yals_len_to_weight (yals, len);
-  yals->xorweight = ((float)yals->opts.xorweight.val / 100.0f);
-  if (yals->crit) {
-    memset (yals->weightedbreak, 0, 2*yals->nvars*sizeof(float));
-    memset (yals->xweightedbreak, 0, yals->nvars*sizeof(float));
-  }
-  for (cidx = 0; cidx < yals->nclauses; cidx++) {
+  for (cidx = from; cidx < yals->nclauses; cidx++) {
     satcnt = 0;
     lits = yals_lits (yals, cidx);
     crit = 0;
@@ -2377,9 +3275,14 @@ static void yals_update_sat_and_unsat (Yals * yals) {
       satcnt++;
     }
 
-    if (yals->crit) yals->crit[cidx] = crit;
     len = p - lits;
     cappedlen = MIN (len, MAXLEN);
+    if (yals->recs) {
+      yals->recs[cidx].crit = crit;
+      if (yals->usecrit == CRIT_FIXED)
+        yals->recs[cidx].iweight = yals->iweights[cappedlen];
+      else yals->recs[cidx].weight = yals->weights[cappedlen];
+    } else if (yals->usecrit) yals->crit[cidx] = crit;
     LOGCIDX (cidx,
        "sat count %u length %d weight %u for",
        satcnt, len, yals->weights[cappedlen]);
@@ -2387,27 +3290,118 @@ static void yals_update_sat_and_unsat (Yals * yals) {
     if (!satcnt) {
       yals_enqueue (yals, cidx);
       LOGCIDX (cidx, "broken");
-    } else if (yals->crit && satcnt == 1)
-      yals_inc_weighted_break (yals, yals->crit[cidx], yals->weights[cappedlen]); // TODO avoid mem on yals->weights if uniform weights
+    } else if (yals->usecrit && satcnt == 1)
+      yals_inc_len_break (yals, crit, cappedlen, yals->usecrit); // TODO avoid mem on yals->weights if uniform weights
   }
+}
 
-  for (cidx = 0; cidx < yals->nxclauses; cidx++) {
-    lits = yals_xlits(yals, cidx);
-    U1 sat = *(yals->xparitydb.start + cidx);
-    for (p = lits; (lit = *p); p++) {
-      sat ^= yals_val(yals, lit);
+// Same for the XOR clauses starting at 'from'.  They are evaluated a word
+// of clauses at a time: the parity word is xor'ed with the values of each
+// clause.  Bits of clauses before 'from' in the first word are kept.
+
+static void yals_init_xclauses (Yals * yals, int from) {
+  int lit, cidx, w;
+  const int * p;
+  for (w = from / BITS_PER_WORD; w < yals->nxwords; w++) {
+    Word sat = yals->xparitydb.start[w], valid, todo;
+    int base = w * BITS_PER_WORD, first = MAX (base, from);
+    int last = MIN (base + (int) BITS_PER_WORD, yals->nxclauses);
+    for (cidx = first; cidx < last; cidx++) {
+      Word val = 0;
+      if (yals->xmasks) val = yals_xorval (yals, cidx);
+      else for (p = yals_xlits (yals, cidx); (lit = *p); p++)
+        val ^= yals_val (yals, lit);
+      sat ^= val << (cidx & BITMAPMASK);
     }
-    yals_setxorsat(yals, cidx, sat);
-    if (!sat) {
+    valid = (last - base < (int) BITS_PER_WORD) ? BIT (last - base) - 1 : ~(Word) 0;
+    valid &= ~(BIT (first - base) - 1);
+    sat &= valid;
+    yals->xorsat[w] = (yals->xorsat[w] & ~valid) | sat;
+    for (todo = valid & ~sat; todo; todo &= todo - 1) {
+      cidx = base + yals_ctz (todo);
       yals_enqueue (yals, yals->nclauses + cidx);
       LOGCIDX (yals->nclauses + cidx, "broken");
-    } else if (yals->crit) {
-      for (p = lits; (lit = *p); p++) {
+    }
+    if (!yals->usecrit) continue;
+    for (todo = sat; todo; todo &= todo - 1) {
+      cidx = base + yals_ctz (todo);
+      for (p = yals_xlits (yals, cidx); (lit = *p); p++) {
         // In a satisfied XOR clause, every literal is critical
-        yals_inc_xweighted_break(yals, lit, yals->xorweight);
+        yals_inc_xor_break (yals, lit, yals->usecrit);
       }
     }
   }
+}
+
+static void yals_update_sat_and_unsat (Yals * yals) {
+  int len;
+  yals_log_assignment (yals);
+  yals_reset_unsat (yals);
+  for (len = 1; len <= MAXLEN; len++) {
+    yals->weights[len] = yals_len_to_weight (yals, len);
+    yals->iweights[len] = yals_len_to_iweight (yals, len);
+  }
+  yals->xorweight = ((float)yals->opts.xorweight.val / 100.0f);
+  yals->ixorweight = yals->opts.xorweight.val;
+  if (yals->usecrit) {
+    memset (yals->weightedbreak, 0, 2*yals->nvars*sizeof(float));
+    memset (yals->xweightedbreak, 0, yals->nvars*sizeof(float));
+  }
+  yals_init_clauses (yals, 0);
+  yals_init_xclauses (yals, 0);
+  yals_check_xweighted_breaks (yals);
+  yals_check_global_invariant (yals);
+}
+
+// Restarts often pick an assignment close to the current one, e.g. the
+// best or a cached one.  If at most 'restartdiff' percent of variables
+// differ from the assignment saved in 'old' before picking, the old one
+// is restored and only the differing variables are flipped through the
+// make and break updates.  Then satisfied counters, critical literals,
+// break values and the unsatisfied clauses stay valid without rescanning
+// all clauses.  Clause weights only depend on options and do not change.
+
+static void yals_restart_sat_and_unsat (Yals * yals) {
+  const int usequeue = yals->unsat.usequeue;
+  const int nvarwords = yals->nvarwords;
+  int64_t limit;
+  int i, idx, lit, diffs;
+  Word * vals = yals->vals, * old = yals->old, d, tmp;
+
+  limit = (int64_t) yals->opts.restartdiff.val * (yals->nvars - 1) / 100;
+  for (diffs = i = 0; i < nvarwords; i++) {
+    d = vals[i] ^ old[i];
+    if (!i) d &= ~(Word) 1;
+    diffs += yals_popcount (d);
+  }
+  if (diffs > limit) { yals_update_sat_and_unsat (yals); return; }
+
+  yals->stats.restart.inner.incremental++;
+  yals->stats.restart.inner.diffs += diffs;
+  yals_msg (yals, 2, "incremental restart flipping %d variables", diffs);
+  for (i = 0; i < nvarwords; i++)
+    tmp = vals[i], vals[i] = old[i], old[i] = tmp;
+  for (i = 0; i < nvarwords; i++) {
+    d = vals[i] ^ old[i];
+    if (!i) d &= ~(Word) 1;
+    for (; d; d &= d - 1) {
+      idx = i * BITS_PER_WORD + yals_ctz (d);
+      if (idx >= yals->nvars) break;
+      lit = GETBIT (old, nvarwords, idx) ? idx : -idx;
+      LOG ("restart flipping %d", lit);
+      NOTBIT (vals, nvarwords, idx);
+      yals_make_clauses_after_flipping_lit (yals, lit,
+        yals->satcntbytes, yals->recs != 0, yals->usecrit, yals->wideoccs,
+        usequeue);
+      yals_break_clauses_after_flipping_lit (yals, lit,
+        yals->satcntbytes, yals->recs != 0, yals->usecrit, yals->wideoccs,
+        usequeue);
+      yals_flip_xclauses_after_flipping_lit (yals, lit,
+        yals->usecrit, yals->wideoccs, usequeue);
+    }
+  }
+  memcpy (vals, old, nvarwords * sizeof (Word));
+  yals_log_assignment (yals);
   yals_check_xweighted_breaks (yals);
   yals_check_global_invariant (yals);
 }
@@ -2432,6 +3426,15 @@ static void yals_init_weight_to_score_table (Yals * yals) {
     "exponential base cb = %f for maxlen %d",
     cb, maxlen);
 
+  if (!EMPTY (yals->exp.table.cb) && yals->exp.cb == yals->opts.cb.val) {
+    yals_msg (yals, 1, "reusing exp2 and pow tables");
+    goto FIXED;
+  }
+  RELEASE (yals->exp.table.two);
+  RELEASE (yals->exp.table.cb);
+  RELEASE (yals->exp.table.fixed);
+  yals->exp.cb = yals->opts.cb.val;
+
   eps = 0;
   invcb = 1.0 / pow(cb, 0.01);
   score = start;
@@ -2462,16 +3465,264 @@ static void yals_init_weight_to_score_table (Yals * yals) {
   yals->exp.max.cb = i;
   yals->exp.eps.cb = eps;
   yals_msg (yals, 1, "pow(%f,(<= %d)) = %g", cb, -i, eps);
+
+FIXED:
+  if (yals->usecrit != CRIT_FIXED) return;
+  if (!EMPTY (yals->exp.table.fixed)) {
+    yals_msg (yals, 1, "reusing fixed-point score table");
+    return;
+  }
+
+  // Fixed-point break weights are in hundredths, thus combine both tables
+  // into one, which gives the same scores as the float version.
+
+  eps = 0.0;
+  for (i = 0; i/100 < yals->exp.max.cb; i++) {
+    score = PEEK (yals->exp.table.cb, i/100);
+    score *= PEEK (yals->exp.table.two, i%100);
+    if (!score) break;
+    PUSH (yals->exp.table.fixed, score);
+    eps = score;
+  }
+  assert (eps > 0);
+  assert (i == COUNT (yals->exp.table.fixed));
+  yals->exp.max.fixed = i;
+  yals->exp.eps.fixed = eps;
+  yals_msg (yals, 1, "fixed-point score table with %u entries", i);
 }
 
 /*------------------------------------------------------------------------*/
 
+// Maps user literals to internal ones and back if renumbered.
+
+static int yals_import_lit (Yals * yals, int lit) {
+  int idx = ABS (lit);
+  if (!yals->e2i || idx >= yals->nvars) return lit;
+  idx = yals->e2i[idx];
+  return lit < 0 ? -idx : idx;
+}
+
+static int yals_export_lit (Yals * yals, int lit) {
+  int idx = ABS (lit);
+  if (!yals->i2e) return lit;
+  assert_valid_idx (idx);
+  idx = yals->i2e[idx];
+  return lit < 0 ? -idx : idx;
+}
+
+// Renumbers variables and clauses in breadth-first order over the
+// variable-clause incidence graph, such that clauses sharing variables and
+// variables sharing clauses are close in 'satcnt', 'crit', 'weightedbreak'
+// etc. during flipping.  Done in 'yals_prepare' right before
+// 'yals_connect_formula', so grouping small clauses afterwards keeps the
+// order within each group.
+
+static void yals_reorder (Yals * yals) {
+  int nvars = yals->nvars, nclauses, nxclauses, ncls, nlits, nxlits;
+  int * cstart, * first, * inc, * queue, * order, * cdb, * xcdb, * c, * x;
+  int cidx, xcidx, idx, lit, head, tail, n, next, i;
+  Word * xparities;
+  const int * p, * q;
+  int * r;
+  signed char * seen;
+  size_t bytes;
+
+  nclauses = nxclauses = 0;
+  for (p = yals->cdb.start; p < yals->cdb.top; p++) if (!*p) nclauses++;
+  for (p = yals->xcdb.start; p < yals->xcdb.top; p++) if (!*p) nxclauses++;
+  ncls = nclauses + nxclauses;
+  nlits = COUNT (yals->cdb);
+  nxlits = COUNT (yals->xcdb);
+
+  // Start of each clause, OR clauses first followed by XOR clauses
+  NEWN (cstart, ncls + 1);
+  n = 0;
+  for (p = yals->cdb.start; p < yals->cdb.top; p = q + 1) {
+    cstart[n++] = p - yals->cdb.start;
+    for (q = p; *q; q++)
+      ;
+  }
+  for (p = yals->xcdb.start; p < yals->xcdb.top; p = q + 1) {
+    cstart[n++] = p - yals->xcdb.start;
+    for (q = p; *q; q++)
+      ;
+  }
+  assert (n == ncls);
+
+#define CLAUSE(CIDX) \
+  (((CIDX) < nclauses ? yals->cdb.start : yals->xcdb.start) + cstart[CIDX])
+
+  // Incidence lists of clauses for each variable
+  NEWN (first, nvars + 1);
+  for (cidx = 0; cidx < ncls; cidx++)
+    for (p = CLAUSE (cidx); (lit = *p); p++)
+      first[ABS (lit)]++;
+  for (idx = 1; idx <= nvars; idx++) first[idx] += first[idx - 1];
+  NEWN (inc, first[nvars]);
+  for (cidx = ncls - 1; cidx >= 0; cidx--)
+    for (p = CLAUSE (cidx); (lit = *p); p++)
+      inc[--first[ABS (lit)]] = cidx;
+
+  // Breadth-first search numbering variables on their first visit and
+  // clauses on their first visit from a variable
+  NEWN (yals->e2i, nvars);
+  NEWN (yals->i2e, nvars);
+  NEWN (queue, nvars);
+  NEWN (order, ncls);
+  NEWN (seen, ncls);
+  next = 1;
+  n = 0;
+  for (idx = 1; idx < nvars; idx++) {
+    if (yals->e2i[idx] || first[idx] == first[idx + 1]) continue;
+    yals->e2i[idx] = next++;
+    head = tail = 0;
+    queue[tail++] = idx;
+    while (head < tail) {
+      int v = queue[head++];
+      for (i = first[v]; i < first[v + 1]; i++) {
+        cidx = inc[i];
+        if (seen[cidx]) continue;
+        seen[cidx] = 1;
+        order[n++] = cidx;
+        for (p = CLAUSE (cidx); (lit = *p); p++) {
+          int u = ABS (lit);
+          if (yals->e2i[u]) continue;
+          yals->e2i[u] = next++;
+          queue[tail++] = u;
+        }
+      }
+    }
+  }
+  assert (n == ncls);
+  for (idx = 1; idx < nvars; idx++)
+    if (!yals->e2i[idx]) yals->e2i[idx] = next++;
+  assert (next == MAX (nvars, 1));
+  for (idx = 1; idx < nvars; idx++) yals->i2e[yals->e2i[idx]] = idx;
+
+  // Copy clauses in the new order with renumbered variables
+  NEWN (cdb, nlits);
+  NEWN (xcdb, nxlits);
+  bytes = COUNT (yals->xparitydb) * sizeof (Word);
+  NEWN (xparities, COUNT (yals->xparitydb));
+  c = cdb, x = xcdb, xcidx = 0;
+  for (i = 0; i < ncls; i++) {
+    cidx = order[i];
+    if (cidx < nclauses) {
+      for (p = CLAUSE (cidx); (lit = *p); p++)
+        *c++ = yals_import_lit (yals, lit);
+      *c++ = 0;
+    } else {
+      for (p = CLAUSE (cidx); (lit = *p); p++)
+        *x++ = yals->e2i[lit];
+      *x++ = 0;
+      if (yals_xparity (yals, cidx - nclauses))
+        xparities[xcidx >> LD_BITS_PER_WORD] |= BIT (xcidx);
+      xcidx++;
+    }
+  }
+  assert (c == cdb + nlits);
+  assert (x == xcdb + nxlits);
+  assert (xcidx == nxclauses);
+#undef CLAUSE
+  memcpy (yals->cdb.start, cdb, nlits * sizeof (int));
+  memcpy (yals->xcdb.start, xcdb, nxlits * sizeof (int));
+  memcpy (yals->xparitydb.start, xparities, bytes);
+
+  for (r = yals->trail.start; r < yals->trail.top; r++)
+    *r = yals_import_lit (yals, *r);
+  for (r = yals->phases.start; r < yals->phases.top; r++)
+    *r = yals_import_lit (yals, *r);
+
+  DELN (xparities, COUNT (yals->xparitydb));
+  DELN (xcdb, nxlits);
+  DELN (cdb, nlits);
+  DELN (seen, ncls);
+  DELN (order, ncls);
+  DELN (queue, nvars);
+  DELN (inc, first[nvars]);
+  DELN (first, nvars + 1);
+  DELN (cstart, ncls + 1);
+
+  yals_msg (yals, 1,
+    "renumbered %d variables, %d OR and %d XOR clauses in BFS order",
+    nvars - 1, nclauses, nxclauses);
+}
+
+// Moves binary and then ternary OR clauses to the front of the clause
+// database, such that their literals can be found at a fixed stride from
+// the clause index without going through 'yals->lits'.
+
+static void yals_inline_small_clauses (Yals * yals) {
+  int * cdb, * bin, * trn, * large, len;
+  const int * p, * q;
+  size_t bytes = COUNT (yals->cdb) * sizeof (int);
+  NEWN (cdb, COUNT (yals->cdb));
+  bin = cdb;
+  trn = bin + 3*yals->nbin;
+  large = trn + 4*yals->ntrn;
+  for (p = yals->cdb.start; p < yals->cdb.top; p = q + 1) {
+    int ** dst;
+    for (q = p; *q; q++)
+      ;
+    len = q - p;
+    if (len == 2) dst = &bin;
+    else if (len == 3) dst = &trn;
+    else dst = &large;
+    memcpy (*dst, p, (len + 1) * sizeof (int));
+    *dst += len + 1;
+  }
+  assert (bin == cdb + 3*yals->nbin);
+  assert (trn == cdb + 3*yals->nbin + 4*yals->ntrn);
+  assert (large == cdb + COUNT (yals->cdb));
+  memcpy (yals->cdb.start, cdb, bytes);
+  DELN (cdb, COUNT (yals->cdb));
+  yals->inlinesmall = 1;
+  yals_msg (yals, 1,
+    "inlined %d binary and %d ternary OR clauses",
+    yals->nbin, yals->ntrn);
+}
+
+// Group the variables of each XOR clause by the word of `vals` they live
+// in.  Variables occurring twice cancel out as they do in the parity.
+
+static void yals_init_xmasks (Yals * yals) {
+  int cidx, idx, n, * wpos;
+  const int * p;
+  XMask * m;
+  yals->nxmasks = COUNT (yals->xcdb) - yals->nxclauses;
+  NEWN (yals->xmasks, yals->nxmasks);
+  NEWN (yals->xmaskrefs, yals->nxclauses + 1);
+  NEWN (wpos, yals->nvarwords);
+  n = 0;
+  for (cidx = 0; cidx < yals->nxclauses; cidx++) {
+    yals->xmaskrefs[cidx] = n;
+    for (p = yals_xlits (yals, cidx); (idx = *p); p++) {
+      int w = idx >> LD_BITS_PER_WORD, pos = wpos[w];
+      if (pos < yals->xmaskrefs[cidx] || pos >= n ||
+          yals->xmasks[pos].word != w) {
+        pos = wpos[w] = n++;
+        assert (n <= yals->nxmasks);
+        m = yals->xmasks + pos;
+        m->word = w;
+        m->mask = 0;
+      }
+      yals->xmasks[pos].mask ^= BIT (idx);
+    }
+  }
+  yals->xmaskrefs[cidx] = n;
+  DELN (wpos, yals->nvarwords);
+  yals_msg (yals, 1,
+    "%d XOR parity word masks for %d XOR literals",
+    n, yals->nxmasks);
+}
+
 // Computes positions of clauses in the database, literal occurrences in the formula,
-// and some statistics
-static void yals_connect (Yals * yals) {
+// and some statistics.  Everything computed here is read-only during search
+// and can be shared with other instances (see 'yals_attach').
+static void yals_connect_formula (Yals * yals) {
   int idx, n, lit, nvars = yals->nvars, * count, cidx, sign;
   long long sumoccs, sumlen; int minoccs, maxoccs, minlen, maxlen;
-  int * occsptr, occs, len, lits, nused, uniform;
+  int * occsptr, occs, len, lits, nused;
   int nclauses, nbin, ntrn, nquad, nlarge;
   const int * p,  * q;
 
@@ -2528,21 +3779,16 @@ static void yals_connect (Yals * yals) {
 
   yals->maxlen = maxlen;
   yals->minlen = minlen;
-#ifndef NYALSTATS
-  yals->stats.nincdec = MAX (maxlen + 1, 3);
-  NEWN (yals->stats.inc, yals->stats.nincdec);
-  NEWN (yals->stats.dec, yals->stats.nincdec);
-#endif
-
-  if ((INT_MAX >> LENSHIFT) < nclauses)
-    yals_abort (yals,
-      "maximum number of OR clauses %d exceeded",
-      (INT_MAX >> LENSHIFT));
 
-  if ((INT_MAX >> LENSHIFT) < nxclauses)
-    yals_abort (yals,
-      "maximum number of XOR clauses %d exceeded",
+  yals->wideoccs = yals->opts.wideoccs.val;
+  if (!yals->wideoccs &&
+      ((INT_MAX >> LENSHIFT) < nclauses ||
+       (INT_MAX >> LENSHIFT) < nxclauses)) {
+    yals_msg (yals, 1,
+      "more than %d clauses thus storing clause lengths separately",
       (INT_MAX >> LENSHIFT));
+    yals->wideoccs = 1;
+  }
 
   yals->nclauses = nclauses;
   yals->nxclauses = nxclauses;
@@ -2550,11 +3796,15 @@ static void yals_connect (Yals * yals) {
   yals->ntrn = ntrn;
   yals_msg (yals, 1, "connecting %d OR clauses, %d XOR clauses", nclauses, nxclauses);
 
+  if (yals->opts.inlinesmall.val) yals_inline_small_clauses (yals);
+
   // Init yals->lits
-  NEWN (yals->lits, nclauses);
+  NEWN (yals->lits, yals_nlits (yals));
   lits = 0;
   for (cidx = 0; cidx < nclauses; cidx++) {
-    yals->lits[cidx] = lits;
+    if (!yals->inlinesmall || cidx >= nbin + ntrn)
+      yals->lits[cidx - (nclauses - yals_nlits (yals))] = lits;
+    assert (yals_lits (yals, cidx) == yals->cdb.start + lits);
     while (PEEK (yals->cdb, lits)) lits++;
     lits++;
   }
@@ -2570,8 +3820,6 @@ static void yals_connect (Yals * yals) {
   }
   assert (lits == COUNT (yals->xcdb));
 
-  NEWN (yals->weights, MAXLEN + 1);
-
   NEWN (count, 2*nvars);
   count += nvars;
   int * xcount;
@@ -2660,19 +3908,6 @@ static void yals_connect (Yals * yals) {
       nlarge, yals_pct (nlarge, yals->nclauses));
   }
 
-  if (minlen == maxlen && !yals->opts.toggleuniform.val) uniform = 1;
-  else if (minlen != maxlen && yals->opts.toggleuniform.val) uniform = 1;
-  else uniform = 0;
-
-  if (uniform) {
-    yals_msg (yals, 1,
-      "using uniform strategy for clauses of length %d", maxlen);
-    yals->uniform = maxlen;
-  } else {
-    yals_msg (yals, 1, "using standard non-uniform strategy");
-    yals->uniform = 0;
-  }
-
   yals_msg (yals, 1,
     "clause variable ratio %.3f = %d / %d",
     yals_avg (nclauses, nused), nclauses, nused);
@@ -2689,17 +3924,19 @@ static void yals_connect (Yals * yals) {
 
   // Init yals->occs by writing, for each clause in which it occurs,
   // a bitpacked (clause index, clause length) value into each literal's
-  // occurrences array
+  // occurrences array, or just the clause index if `wideoccs` is set
+  if (yals->wideoccs) NEWN (yals->lens, yals->nclauses);
   for (cidx = 0; cidx < yals->nclauses; cidx++) {
     p = yals_lits (yals, cidx);
     len = 0;
     while (len < MAXLEN && p[len]) len++;
+    if (yals->wideoccs) yals->lens[cidx] = len;
     while ((lit = *p++)) {
       occsptr = yals_refs (yals, lit);
       occs = *occsptr;
       assert_valid_occs (occs);
       assert (!yals->occs[occs]);
-      yals->occs[occs] = (cidx << LENSHIFT) | len;
+      yals->occs[occs] = yals->wideoccs ? cidx : (cidx << LENSHIFT) | len;
       *occsptr = occs + 1;
     }
   }
@@ -2715,7 +3952,7 @@ static void yals_connect (Yals * yals) {
       occs = *occsptr;
       assert_valid_occs(occs);
       assert (!yals->occs[occs]);
-      yals->occs[occs] = (cidx << LENSHIFT) | len;
+      yals->occs[occs] = yals->wideoccs ? cidx : (cidx << LENSHIFT) | len;
       *occsptr = occs + 1;
     }
   }
@@ -2749,23 +3986,6 @@ static void yals_connect (Yals * yals) {
     "average literal occurrence %.2f (min %d, max %d)",
     yals_avg (sumoccs, yals->nvars)/2.0, minoccs, maxoccs);
 
-  if (yals->uniform) yals->pick = yals->opts.unipick.val;
-  else yals->pick = yals->opts.pick.val;
-
-  yals_msg (yals, 1, "picking %s", yals_pick_to_str (yals));
-
-  yals->unsat.usequeue = (yals->pick > 0);
-
-  yals_msg (yals, 1,
-    "using %s for unsat clauses",
-    yals->unsat.usequeue ? "queue" : "stack");
-
-  if (yals->unsat.usequeue) NEWN (yals->lnk, nclauses + nxclauses);
-  else {
-    NEWN (yals->pos, nclauses + nxclauses);
-    for (cidx = 0; cidx < nclauses + nxclauses; cidx++) yals->pos[cidx] = -1;
-  }
-
   yals->nvarwords = (nvars + BITS_PER_WORD - 1) / BITS_PER_WORD;
 
   yals_msg (yals, 1, "%d x %d-bit words per assignment (%d bytes = %d KB)",
@@ -2786,15 +4006,77 @@ static void yals_connect (Yals * yals) {
   }
   RELEASE (yals->trail);
 
+  assert (yals->nxparities == yals->nxclauses);
+  if (yals->opts.xmasks.val && yals->nxclauses) yals_init_xmasks (yals);
+}
+
+// Length of all clauses if the uniform strategy is used and zero otherwise.
+
+static int yals_uniform (Yals * yals) {
+  const int maxlen = yals->maxlen;
+  if (yals->minlen == maxlen && !yals->opts.toggleuniform.val) return maxlen;
+  if (yals->minlen != maxlen && yals->opts.toggleuniform.val) return maxlen;
+  return 0;
+}
+
+// Allocates and initializes the mutable search state of this instance.
+
+static void yals_connect (Yals * yals) {
+  const int nvars = yals->nvars, nclauses = yals->nclauses;
+  const int nxclauses = yals->nxclauses, maxlen = yals->maxlen;
+  int cidx;
+
+#ifndef NYALSTATS
+  yals->stats.nincdec = MAX (maxlen + 1, 3);
+  NEWN (yals->stats.inc, yals->stats.nincdec);
+  NEWN (yals->stats.dec, yals->stats.nincdec);
+#endif
+
+  NEWN (yals->weights, MAXLEN + 1);
+  NEWN (yals->iweights, MAXLEN + 1);
+
+  if ((yals->uniform = yals_uniform (yals)))
+    yals_msg (yals, 1,
+      "using uniform strategy for clauses of length %d", maxlen);
+  else
+    yals_msg (yals, 1, "using standard non-uniform strategy");
+
+  if (yals->uniform) yals->pick = yals->opts.unipick.val;
+  else yals->pick = yals->opts.pick.val;
+
+  yals_msg (yals, 1, "picking %s", yals_pick_to_str (yals));
+
+  yals->unsat.usequeue = (yals->pick > 0);
+  yals->unsat.usedeque = yals->unsat.usequeue && yals->opts.deque.val;
+
+  yals_msg (yals, 1,
+    "using %s for unsat clauses",
+    yals->unsat.usedeque ? "deque" :
+    yals->unsat.usequeue ? "queue" : "stack");
+
+  if (yals->unsat.usequeue && !yals->unsat.usedeque)
+    NEWN (yals->lnk, nclauses + nxclauses);
+  else {
+    NEWN (yals->pos, nclauses + nxclauses);
+    for (cidx = 0; cidx < nclauses + nxclauses; cidx++) yals->pos[cidx] = -1;
+  }
+
   // Init the assignment
   NEWN (yals->vals, yals->nvarwords);
 
   // Init some other stuff
-  NEWN (yals->best, yals->nvarwords);
+  if (!yals->best) NEWN (yals->best, yals->nvarwords);
   NEWN (yals->tmp, yals->nvarwords);
+  NEWN (yals->old, yals->nvarwords);
   NEWN (yals->flips, nvars);
 
-  if (maxlen < (1<<8)) {
+  if (yals->opts.records.val) {
+    yals->satcntbytes = sizeof yals->recs->satcnt;
+    NEWN (yals->recs, yals->nclauses);
+    yals_msg (yals, 1,
+      "using %d bytes per clause record of satcnt, crit and weight",
+      (int) sizeof *yals->recs);
+  } else if (maxlen < (1<<8)) {
     yals->satcntbytes = 1;
     NEWN (yals->satcnt1, yals->nclauses);
   } else if (maxlen < (1<<16)) {
@@ -2804,28 +4086,155 @@ static void yals_connect (Yals * yals) {
     yals->satcntbytes = 4;
     NEWN (yals->satcnt4, yals->nclauses);
   }
-  yals_msg (yals, 1,
-    "need %d bytes per clause for counting satisfied literals",
-    yals->satcntbytes);
+  if (!yals->recs)
+    yals_msg (yals, 1,
+      "need %d bytes per clause for counting satisfied literals",
+      yals->satcntbytes);
 
-  NEWN (yals->xorsat, yals->nxclauses);
+  yals->nxwords = (yals->nxclauses + BITS_PER_WORD - 1) / BITS_PER_WORD;
+  NEWN (yals->xorsat, yals->nxwords);
 
   if (yals->opts.crit.val) {
 
     yals_msg (yals, 1,
       "dynamically computing break values on-the-fly "
       "using critical literals");
-    NEWN (yals->crit, nclauses);
+    yals->usecrit = yals->opts.intweights.val ? CRIT_FIXED : CRIT_FLOAT;
+    if (!yals->recs) NEWN (yals->crit, nclauses);
     NEWN (yals->weightedbreak, 2*nvars);
     NEWN (yals->xweightedbreak, nvars);
   } else
     yals_msg (yals, 1, "eagerly computing break values");
 
   yals_init_weight_to_score_table (yals);
+#ifdef YALS_AVX2
+  if (yals->opts.simd.val && yals->usecrit != CRIT_FIXED) {
+    __builtin_cpu_init ();
+    yals->avx2 = __builtin_cpu_supports ("avx2");
+  }
+#endif
+  yals_msg (yals, 1,
+    "computing break scores %s",
+    yals->avx2 ? "vectorized with AVX2" : "scalar");
+  yals_select_flip_kernel (yals);
+}
+
+// Releases what 'yals_connect' allocated except for the best assignment,
+// which is kept for warm starting the next 'yals_sat' call.
+
+static void yals_disconnect (Yals * yals) {
+  if (!yals->vals) return;
+  yals_reset_unsat (yals);
+  if (yals->unsat.usequeue && !yals->unsat.usedeque)
+    DELN (yals->lnk, yals->nclauses + yals->nxclauses);
+  else DELN (yals->pos, yals->nclauses + yals->nxclauses);
+  if (yals->crit) DELN (yals->crit, yals->nclauses);
+  if (yals->weightedbreak) DELN (yals->weightedbreak, 2*yals->nvars);
+  if (yals->xweightedbreak) DELN (yals->xweightedbreak, yals->nvars);
+  if (yals->recs) DELN (yals->recs, yals->nclauses);
+  else if (yals->satcntbytes == 1) DELN (yals->satcnt1, yals->nclauses);
+  else if (yals->satcntbytes == 2) DELN (yals->satcnt2, yals->nclauses);
+  else DELN (yals->satcnt4, yals->nclauses);
+  DELN (yals->xorsat, yals->nxwords);
+  DELN (yals->weights, MAXLEN + 1);
+  DELN (yals->iweights, MAXLEN + 1);
+  DELN (yals->vals, yals->nvarwords);
+  DELN (yals->tmp, yals->nvarwords);
+  DELN (yals->old, yals->nvarwords);
+  DELN (yals->flips, yals->nvars);
+#ifndef NYALSTATS
+  DELN (yals->stats.inc, yals->stats.nincdec);
+  DELN (yals->stats.dec, yals->stats.nincdec);
+#endif
+  yals->lnk = 0, yals->pos = 0, yals->crit = 0, yals->recs = 0;
+  yals->weightedbreak = 0, yals->xweightedbreak = 0, yals->satcnt1 = 0;
+  yals->xorsat = 0, yals->weights = 0, yals->iweights = 0;
+  yals->vals = yals->tmp = yals->old = 0;
+  yals->flips = 0;
+  yals->usecrit = 0;
+  yals->avx2 = 0;
+}
+
+// Whether the search state of 'yals_connect' still fits after clauses were
+// added, i.e., the strategy and the widths of the counters, which depend
+// on clause lengths, stay the same.
+
+static int yals_keep_search (Yals * yals) {
+  const int maxlen = yals->maxlen;
+  if (yals_uniform (yals) != yals->uniform) return 0;
+#ifndef NYALSTATS
+  if (maxlen >= yals->stats.nincdec) return 0;
+#endif
+  if (yals->recs) return 1;
+  if (yals->satcntbytes == 1) return maxlen < (1<<8);
+  if (yals->satcntbytes == 2) return maxlen < (1<<16);
+  return 1;
+}
+
+// Dequeues or enqueues the unsatisfied XOR clauses among the first 'n',
+// since their indices shift if OR clauses are added.
+
+static void yals_queue_xclauses (Yals * yals, int n, int enqueue) {
+  int cidx;
+  for (cidx = 0; cidx < n; cidx++) {
+    if (yals_xorsat (yals, cidx)) continue;
+    if (enqueue) yals_enqueue (yals, yals->nclauses + cidx);
+    else yals_dequeue_kernel (yals, yals->nclauses + cidx,
+           yals->unsat.usequeue);
+  }
+}
+
+// Grows the search state to the OR clauses after the first 'nclauses' and
+// the XOR clauses after the first 'nxclauses' and initializes them for
+// the current assignment.  The rest of the state stays valid.
+
+static void yals_extend_search (Yals * yals, int nclauses, int nxclauses) {
+  const int total = yals->nclauses + yals->nxclauses;
+  const int nxwords = (yals->nxclauses + BITS_PER_WORD - 1) / BITS_PER_WORD;
+  int cidx;
+  if (yals->unsat.usequeue && !yals->unsat.usedeque) {
+    RSZ (yals->lnk, nclauses + nxclauses, total);
+    for (cidx = nclauses; cidx < total; cidx++) yals->lnk[cidx] = 0;
+  } else {
+    RSZ (yals->pos, nclauses + nxclauses, total);
+    for (cidx = nclauses; cidx < total; cidx++) yals->pos[cidx] = -1;
+  }
+  if (yals->crit) RSZ (yals->crit, nclauses, yals->nclauses);
+  if (yals->recs) RSZ (yals->recs, nclauses, yals->nclauses);
+  else if (yals->satcntbytes == 1)
+    RSZ (yals->satcnt1, nclauses, yals->nclauses);
+  else if (yals->satcntbytes == 2)
+    RSZ (yals->satcnt2, nclauses, yals->nclauses);
+  else RSZ (yals->satcnt4, nclauses, yals->nclauses);
+  RSZ (yals->xorsat, yals->nxwords, nxwords);
+  yals->nxwords = nxwords;
+  if (nclauses < yals->nclauses) yals_queue_xclauses (yals, nxclauses, 1);
+  yals_init_clauses (yals, nclauses);
+  yals_init_xclauses (yals, nxclauses);
+  yals_check_xweighted_breaks (yals);
+  yals_check_global_invariant (yals);
+  yals_msg (yals, 1, "extended search state to added clauses");
 }
 
 /*------------------------------------------------------------------------*/
 
+// Options read by 'yals_connect' or baked into the connected search state
+// (clause weights, counter layout, unsat container and flip kernel).  Only
+// changing one of these drops the search state kept between calls.
+
+static const char * yals_search_options[] = {
+  "crit", "deque", "intweights", "kernel", "pick", "records", "simd",
+  "toggleuniform", "unipick", "weight2", "weight3", "weight4", "weight5",
+  "weight6", "weight7", "weight8", "xorweight", 0
+};
+
+static int yals_search_option (const char * name) {
+  const char ** p;
+  for (p = yals_search_options; *p; p++)
+    if (!strcmp (*p, name)) return 1;
+  return 0;
+}
+
 #define SETOPT(NAME,DEFAULT,MIN,MAX,DESCRIPTION) \
 do { \
   int OLD; \
@@ -2848,6 +4257,7 @@ do { \
     yals_msg (yals, 1, \
       "setting option '%s' to %d (previous value %d)", name, val, OLD); \
     yals->opts.NAME.val = val; \
+    if (yals_search_option (name)) yals_disconnect (yals); \
   } \
   return 1; \
 } while (0)
@@ -2977,6 +4387,7 @@ Yals * yals_new_with_mem_mgr (void * mgr,
   yals->stats.tmp = INT_MAX;
   yals->stats.best = INT_MAX;
   yals->stats.last = INT_MAX;
+  yals->cachebest = INT_MAX;
   yals->limits.report.min = INT_MAX;
   yals_inc_allocated (yals, sizeof *yals);
   yals_srand (yals, 0);
@@ -3025,21 +4436,171 @@ Yals * yals_new () {
 }
 
 static void yals_reset_cache (Yals * yals) {
-  int ncache = COUNT (yals->cache);
-  Word ** w;
-  for (w = yals->cache.start; w < yals->cache.top; w++)
-    DELN (*w, yals->nvarwords);
+  int i, ncache = COUNT (yals->cache);
+  for (i = 0; i < ncache; i++)
+    DELN (PEEK (yals->cache, i), PEEK (yals->cachesizes, i));
   RELEASE (yals->cache);
+  RELEASE (yals->cachesizes);
+  RELEASE (yals->cachebuf);
+  if (yals->cacheref) DELN (yals->cacheref, yals->nvarwords);
+  yals->cacheref = 0;
+  CLEAR (yals->sigs);
+  CLEAR (yals->mins);
+  RELEASE (yals->cacheheap);
+  RELEASE (yals->cacheheappos);
+  DELN (yals->cachehash, yals->cachehashsize);
+  yals->cachehash = 0, yals->cachehashsize = 0;
+  yals->cachebest = INT_MAX;
   yals->cachesizetarget = 0;
   yals_msg (yals, 1, "reset %d cache lines", ncache);
 }
 
-void yals_del (Yals * yals) {
-  yals_reset_cache (yals);
-  yals_reset_unsat (yals);
+// Cached assignments are persisted as sections of a header line
+//
+//   p cache <fingerprint> <maxvar> <assignments>
+//
+// followed by one line '<minimum> <lit> ... 0' per assignment listing
+// all external literals.  Reading skips sections of other formulas and
+// keeps at most 'cachemax' distinct assignments with smallest minimum.
+
+static void yals_write_assignment (Yals * yals,
+  FILE * file, const Word * vals, int min) {
+  int idx, lit;
+  fprintf (file, "%d", min);
+  for (idx = 1; idx < yals->nvars; idx++) {
+    lit = ABS (yals_import_lit (yals, idx));
+    fprintf (file, " %d", GETBIT (vals, yals->nvarwords, lit) ? idx : -idx);
+  }
+  fputs (" 0\n", file);
+}
+
+int yals_write_cache (Yals * yals, FILE * file) {
+  int i, best = yals->best && yals->stats.best < INT_MAX, res;
+  Word * vals;
+  if (!yals->prepared || yals->mt)
+    yals_abort (yals, "formula not prepared in 'yals_write_cache'");
+  res = COUNT (yals->cache) + best;
+  fprintf (file, "p cache %016llx %d %d\n",
+    (unsigned long long) yals->fingerprint, yals->nvars - 1, res);
+  if (best)
+    yals_write_assignment (yals, file, yals->best, yals->stats.best);
+  NEWN (vals, yals->nvarwords);
+  for (i = 0; i < COUNT (yals->cache); i++) {
+    yals_cache_decode (yals, i, vals);
+    yals_write_assignment (yals, file, vals, PEEK (yals->mins, i));
+  }
+  DELN (vals, yals->nvarwords);
+  yals_msg (yals, 1, "wrote %d cached assignments", res);
+  return res;
+}
+
+static int yals_load_assignment (Yals * yals, Word * vals, int min) {
+  Word sig = yals_sig_of (yals, vals);
+  int pos;
+  yals_cache_encode (yals, vals);
+  pos = yals_cache_find (yals, sig);
+  if (pos >= 0) {
+    if (min < PEEK (yals->mins, pos))
+      yals_cache_replace (yals, pos, sig, min);
+    return 0;
+  }
+  if (COUNT (yals->cache) < yals->opts.cachemax.val) {
+    yals_cache_push (yals, sig, min);
+    return 1;
+  }
+  if (EMPTY (yals->cache)) return 0;
+  pos = yals_cache_worst (yals);
+  if (PEEK (yals->mins, pos) <= min) return 0;
+  yals_cache_replace (yals, pos, sig, min);
+  return 1;
+}
+
+int yals_read_cache (Yals * yals, FILE * file) {
+  int res = 0, maxvar, n, min, lit, idx, ch, match;
+  unsigned long long fingerprint;
+  Word * vals;
+  if (!yals->prepared || yals->mt)
+    yals_abort (yals, "formula not prepared in 'yals_read_cache'");
+  if (!yals->opts.cachemin.val || !yals->opts.cachemax.val) return 0;
+  NEWN (vals, yals->nvarwords);
+  while (fscanf (file, " p cache %llx %d %d", &fingerprint, &maxvar, &n) == 3) {
+    match = (fingerprint == yals->fingerprint && maxvar == yals->nvars - 1);
+    if (!match)
+      yals_msg (yals, 1,
+        "skipping %d cached assignments of other formula", n);
+    while (n-- > 0) {
+      if (fscanf (file, "%d", &min) != 1 || min < 0) goto DONE;
+      memset (vals, 0, yals->nvarwords * sizeof (Word));
+      while (fscanf (file, "%d", &lit) == 1 && lit) {
+        if (!match) continue;
+        if ((idx = ABS (lit)) > maxvar) goto DONE;
+        idx = ABS (yals_import_lit (yals, idx));
+        if (lit > 0) SETBIT (vals, yals->nvarwords, idx);
+      }
+      if (match) res += yals_load_assignment (yals, vals, min);
+    }
+  }
+DONE:
+  while ((ch = getc (file)) != EOF && isspace (ch))
+    ;
+  if (ch != EOF)
+    yals_warn (yals, "ignoring invalid trailing part of cache file");
+  DELN (vals, yals->nvarwords);
+  if (res) {
+    yals->stats.cache.loaded += res;
+    yals->cacheloaded = 1;
+    if (yals->cachesizetarget < COUNT (yals->cache))
+      yals->cachesizetarget = COUNT (yals->cache);
+    if (yals->cachesizetarget < yals->opts.cachemin.val)
+      yals->cachesizetarget = yals->opts.cachemin.val;
+  }
+  yals_msg (yals, 1, "read %d cached assignments", res);
+  return res;
+}
+
+// Releases the clause and occurrence indices and units computed by
+// 'yals_connect_formula' but keeps the clauses.
+
+static void yals_disconnect_formula (Yals * yals) {
+  DELN (yals->lits, yals_nlits (yals));
+  DELN (yals->xlits, yals->nxclauses);
+  if (yals->xmasks) {
+    DELN (yals->xmasks, yals->nxmasks);
+    DELN (yals->xmaskrefs, yals->nxclauses + 1);
+  }
+  DELN (yals->clear, yals->nvarwords);
+  DELN (yals->set, yals->nvarwords);
+  DELN (yals->occs, yals->noccs);
+  if (yals->lens) DELN (yals->lens, yals->nclauses);
+  if (yals->refs) DELN (yals->refs, 3*yals->nvars);
+  yals->lits = yals->xlits = yals->occs = yals->refs = 0;
+  yals->xmasks = 0, yals->xmaskrefs = 0, yals->lens = 0;
+  yals->set = yals->clear = 0;
+  yals->noccs = yals->garbageoccs = 0;
+  yals->inlinesmall = 0;
+}
+
+// Releases what 'yals_connect_formula' computed unless shared.
+
+static void yals_del_formula (Yals * yals) {
   RELEASE (yals->cdb);
   RELEASE (yals->xcdb);
   RELEASE (yals->xparitydb);
+  if (yals->e2i) DELN (yals->e2i, yals->nvars);
+  if (yals->i2e) DELN (yals->i2e, yals->nvars);
+  yals_disconnect_formula (yals);
+  if (yals->elites) {
+    Elite * e;
+    for (e = yals->elites; e < yals->elites + yals->nelites; e++)
+      DELN (e->vals, yals->nvarwords);
+    DELN (yals->elites, yals->nelites);
+  }
+}
+
+void yals_del (Yals * yals) {
+  yals_reset_cache (yals);
+  yals_disconnect (yals);
+  if (!yals->master) yals_del_formula (yals);
   RELEASE (yals->clause);
   RELEASE (yals->mark);
   RELEASE (yals->mins);
@@ -3049,33 +4610,12 @@ void yals_del (Yals * yals) {
   RELEASE (yals->cands);
   RELEASE (yals->trail);
   RELEASE (yals->phases);
+  RELEASE (yals->assumptions);
   RELEASE (yals->exp.table.two);
   RELEASE (yals->exp.table.cb);
+  RELEASE (yals->exp.table.fixed);
   RELEASE (yals->minlits);
-  if (yals->unsat.usequeue) DELN (yals->lnk, yals->nclauses + yals->nxclauses);
-  else DELN (yals->pos, yals->nclauses + yals->nxclauses);
-  DELN (yals->lits, yals->nclauses);
-  DELN (yals->xlits, yals->nxclauses);
-  if (yals->crit) DELN (yals->crit, yals->nclauses);
-  if (yals->weightedbreak) DELN (yals->weightedbreak, 2*yals->nvars);
-  if (yals->xweightedbreak) DELN (yals->xweightedbreak, yals->nvars);
-  if (yals->satcntbytes == 1) DELN (yals->satcnt1, yals->nclauses);
-  else if (yals->satcntbytes == 2) DELN (yals->satcnt2, yals->nclauses);
-  else DELN (yals->satcnt4, yals->nclauses);
-  DELN(yals->xorsat, yals->nxclauses);
-  if (yals->weights) DELN (yals->weights, MAXLEN + 1);
-  DELN (yals->vals, yals->nvarwords);
   DELN (yals->best, yals->nvarwords);
-  DELN (yals->tmp, yals->nvarwords);
-  DELN (yals->clear, yals->nvarwords);
-  DELN (yals->set, yals->nvarwords);
-  DELN (yals->occs, yals->noccs);
-  if (yals->refs) DELN (yals->refs, 3*yals->nvars);
-  if (yals->flips) DELN (yals->flips, yals->nvars);
-#ifndef NYALSTATS
-  DELN (yals->stats.inc, yals->stats.nincdec);
-  DELN (yals->stats.dec, yals->stats.nincdec);
-#endif
   yals_strdel (yals, yals->opts.prefix);
   yals_dec_allocated (yals, sizeof *yals);
   assert (getenv ("YALSLEAK") || !yals->stats.allocated.current);
@@ -3093,9 +4633,32 @@ void yals_setout (Yals * yals, FILE * out) {
 
 void yals_setphase (Yals * yals, int lit) {
   if (!lit) yals_abort (yals, "zero literal argument to 'yals_val'");
+  if (yals->prepared) lit = yals_import_lit (yals, lit);
   PUSH (yals->phases, lit);
 }
 
+// Variables added after 'yals_prepare' are connected by the next
+// 'yals_sat' call and until then only counted separately.
+
+static void yals_add_var (Yals * yals, int idx) {
+  int * nvars = yals->prepared ? &yals->addednvars : &yals->nvars;
+  if (idx >= *nvars) *nvars = idx + 1;
+}
+
+// Assumed variables not yet in the formula are added like those of new
+// clauses, such that they are frozen and assigned as assumed.
+
+void yals_assume (Yals * yals, int lit) {
+  if (!lit) yals_abort (yals, "zero literal argument to 'yals_assume'");
+  if (lit == INT_MIN || ABS (lit) == INT_MAX)
+    yals_abort (yals, "invalid literal %d in 'yals_assume'", lit);
+  if ((yals->master || yals->attached) && ABS (lit) >= yals->nvars)
+    yals_abort (yals, "can not assume new variable %d of shared formula",
+      ABS (lit));
+  yals_add_var (yals, ABS (lit));
+  PUSH (yals->assumptions, lit);
+}
+
 void yals_setflipslimit (Yals * yals, long long flips) {
   yals->limits.flips = flips;
   yals_msg (yals, 1, "new flips limit %lld", (long long) flips);
@@ -3156,7 +4719,7 @@ static void yals_new_clause (Yals * yals) {
       PUSH (yals->xcdb, idx);
     }
     PUSH(yals->xcdb, 0);
-    PUSH(yals->xparitydb, yals->xorParity);
+    yals_push_xparity (yals, yals->xorParity);
     LOGLITS (yals->xcdb.top - len - 1, "new (length %d, parity %d) XOR", len, yals->xorParity);
   } else {
     for (p = yals->clause.start; p < yals->clause.top; p++) {
@@ -3178,6 +4741,8 @@ void yals_begin_xor_clause (Yals * yals) {
 }
 
 void yals_add (Yals * yals, int lit) {
+  if (yals->master || yals->attached)
+    yals_abort (yals, "can not add literals to shared formula");
   if (lit) { // Add literal to current clause
     if (yals->isXor) {
       int idx;
@@ -3186,7 +4751,7 @@ void yals_add (Yals * yals, int lit) {
       idx = ABS (lit);
       if (idx == INT_MAX)
         yals_abort (yals, "can not add 'INT_MAX' as literal");
-      if (idx >= yals->nvars) yals->nvars = idx + 1;
+      yals_add_var (yals, idx);
       PUSH(yals->clause, lit);
       if (lit < 0) yals->xorParity ^= 1;
       // TODO(WN): triviality conditions?
@@ -3200,7 +4765,7 @@ void yals_add (Yals * yals, int lit) {
     idx = ABS (lit);
     if (idx == INT_MAX)
       yals_abort (yals, "can not add 'INT_MAX' as literal");
-    if (idx >= yals->nvars) yals->nvars = idx + 1;
+    yals_add_var (yals, idx);
     while (idx >= COUNT (yals->mark)) PUSH (yals->mark, 0);
     mark = PEEK (yals->mark, idx);
     if (lit < 0) mark = -mark;
@@ -3226,6 +4791,101 @@ void yals_add (Yals * yals, int lit) {
   }
 }
 
+// Same as calling 'yals_add' for each literal of the zero terminated
+// clauses in 'lits' and 'yals_begin_xor_clause' before the i-th clause if
+// 'xors' is non-zero and 'xors[i]' is set.  Literals are checked and the
+// clause databases reserved in a first pass.  Then clauses are copied
+// directly to 'cdb' and 'xcdb' without going through 'clause'.
+
+void yals_add_clauses (Yals * yals,
+  const int * lits, size_t n, const unsigned char * xors) {
+  size_t nlits, nxlits, ncls, i;
+  int lit, idx, maxidx, isxor, len;
+  const int * p, * end = lits + n;
+  int * start, * q;
+  signed char mark;
+  unsigned parity;
+
+  if (yals->master || yals->attached)
+    yals_abort (yals, "can not add literals to shared formula");
+  if (!EMPTY (yals->clause) || yals->isXor)
+    yals_abort (yals, "added clause incomplete in 'yals_add_clauses'");
+  if (n && lits[n-1])
+    yals_abort (yals, "last clause not terminated in 'yals_add_clauses'");
+
+  nlits = nxlits = ncls = 0;
+  maxidx = -1;
+  for (p = lits; p < end; p++) {
+    if (!(lit = *p)) { ncls++; continue; }
+    if (lit == INT_MIN)
+      yals_abort (yals, "can not add 'INT_MIN' as literal");
+    idx = ABS (lit);
+    if (idx == INT_MAX)
+      yals_abort (yals, "can not add 'INT_MAX' as literal");
+    if (idx > maxidx) maxidx = idx;
+    if (xors && xors[ncls]) nxlits++;
+    else nlits++;
+  }
+  if (maxidx >= 0) yals_add_var (yals, maxidx);
+  while (maxidx >= COUNT (yals->mark)) PUSH (yals->mark, 0);
+  while ((size_t) SIZE (yals->cdb) <
+         (size_t) COUNT (yals->cdb) + nlits + ncls)
+    ENLARGE (yals->cdb);
+  while ((size_t) SIZE (yals->xcdb) <
+         (size_t) COUNT (yals->xcdb) + nxlits + ncls)
+    ENLARGE (yals->xcdb);
+
+  for (p = lits, i = 0; i < ncls; i++, p++) {
+    isxor = xors && xors[i];
+    if (isxor) {
+      start = yals->xcdb.top;
+      for (parity = 0; (lit = *p); p++) {
+        parity ^= (lit < 0);
+        PUSH (yals->xcdb, ABS (lit));
+      }
+    } else {
+      start = yals->cdb.top;
+      for (yals->trivial = 0; (lit = *p); p++) {
+        idx = ABS (lit);
+        mark = PEEK (yals->mark, idx);
+        if (lit < 0) mark = -mark;
+        if (mark < 0) yals->trivial = 1;
+        else if (!mark) {
+          PUSH (yals->cdb, lit);
+          POKE (yals->mark, idx, yals_sign (lit));
+        }
+      }
+      for (q = start; q < yals->cdb.top; q++)
+        POKE (yals->mark, ABS (*q), 0);
+      if (yals->trivial) {
+        yals->trivial = 0;
+        yals->cdb.top = start;
+        continue;
+      }
+    }
+    len = (isxor ? yals->xcdb.top : yals->cdb.top) - start;
+    if (len <= 1) {
+      if (isxor) yals->xcdb.top = start;
+      else yals->cdb.top = start;
+    }
+    if (!len) {
+      LOG ("found empty clause in original formula");
+      yals->mt = 1;
+    } else if (len == 1) {
+      lit = (isxor && parity) ? -*start : *start;
+      LOG ("found unit clause %d in original formula", lit);
+      PUSH (yals->trail, lit);
+    } else if (isxor) {
+      PUSH (yals->xcdb, 0);
+      yals_push_xparity (yals, parity);
+      LOGLITS (start, "new (length %d, parity %d) XOR", len, parity);
+    } else {
+      PUSH (yals->cdb, 0);
+      LOGLITS (start, "new (length %d) OR", len);
+    }
+  }
+}
+
 /*------------------------------------------------------------------------*/
 
 #define ISDEFSTRAT(NAME,ENABLED) \
@@ -3417,6 +5077,7 @@ static void yals_restart_inner (Yals * yals) {
   if ((yals_inc_inner_restart_interval (yals) && yals->opts.verbose.val) ||
       yals->opts.verbose.val >= 2)
     yals_report (yals, "restart %lld", yals->stats.restart.inner.count);
+  if (yals->elites) yals_publish_elite (yals);
   if (yals->stats.best < yals->stats.last) {
     yals->stats.pick.keep++;
     yals_msg (yals, 2,
@@ -3425,8 +5086,9 @@ static void yals_restart_inner (Yals * yals) {
     yals_cache_assignment (yals);
     yals_pick_strategy (yals);
     yals_fix_strategy (yals);
+    memcpy (yals->old, yals->vals, yals->nvarwords * sizeof (Word));
     yals_pick_assignment (yals, 0);
-    yals_update_sat_and_unsat (yals);
+    yals_restart_sat_and_unsat (yals);
     yals->stats.tmp = INT_MAX;
     yals_save_new_minimum (yals);
   }
@@ -3484,7 +5146,7 @@ static int yals_inner_loop (Yals * yals) {
   LOG ("entering yals inner loop");
   while (!(res = yals_done (yals)) && !yals_need_to_restart_outer (yals))
     if (yals_need_to_restart_inner (yals)) yals_restart_inner (yals);
-    else yals_flip (yals);
+    else yals->flip (yals);
   return res;
 }
 
@@ -3525,17 +5187,26 @@ static void yals_restart_outer (Yals * yals) {
   yals_msg (yals, 1,
     "next outer restart limit %lld",
     (long long) yals->limits.restart.outer.lim);
-  yals_reset_cache (yals);
+  if (yals->opts.keepcache.val)
+    yals_msg (yals, 1, "keeping %d cache lines", (int) COUNT (yals->cache));
+  else yals_reset_cache (yals);
   yals->stats.time.restart += yals_time (yals) - start;
 }
 
-static void yals_outer_loop (Yals * yals) {
+// If 'connected' is non-zero the search state kept from the previous
+// 'yals_sat' call is valid for the current assignment.  The first pick
+// then only flips the variables which change (see 'yals_extend_search').
+
+static void yals_outer_loop (Yals * yals, int connected) {
   yals_init_outer_restart_interval (yals);
   for (;;) {
     yals_set_default_strategy (yals);
     yals_fix_strategy (yals);
+    if (connected)
+      memcpy (yals->old, yals->vals, yals->nvarwords * sizeof (Word));
     yals_pick_assignment (yals, 1);
-    yals_update_sat_and_unsat (yals);
+    if (connected) yals_restart_sat_and_unsat (yals), connected = 0;
+    else yals_update_sat_and_unsat (yals);
     yals->stats.tmp = INT_MAX;
     yals_save_new_minimum (yals);
     yals->stats.last = yals_nunsat (yals);
@@ -3576,15 +5247,385 @@ DONE:
   return res;
 }
 
-int yals_sat (Yals * yals) {
-  int res, limited = 0, lkhd;
+// Hash of the clauses and units as added, thus independent of options.
 
-  if (yals->opts.maxorigvar.val != 0) {
-    assert(yals->opts.maxorigvar.val < yals->nvars);
+static uint64_t yals_fingerprint (Yals * yals) {
+  uint64_t res = yals->nvars;
+  const int * p;
+  const Word * w;
+  for (p = yals->cdb.start; p < yals->cdb.top; p++)
+    res = (res + (unsigned) *p) * 1099511628211ull;
+  for (p = yals->xcdb.start; p < yals->xcdb.top; p++)
+    res = (res + (unsigned) *p + 1) * 1099511628211ull;
+  for (w = yals->xparitydb.start; w < yals->xparitydb.top; w++)
+    res = (res + *w) * 1099511628211ull;
+  for (p = yals->trail.start; p < yals->trail.top; p++)
+    res = (res + (unsigned) *p) * 1099511628211ull;
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+// Clauses and units added after 'yals_prepare' are connected by the next
+// 'yals_sat' call without changing the numbering of connected variables
+// and clauses.  Added clauses are simplified by the units fixed so far
+// and appended as new clauses.  Only the occurrence lists of their
+// literals are moved to the end of 'occs' and extended there.  Units on
+// variables which occur in clauses are propagated over the whole formula,
+// which is then connected again.
+
+static int yals_added (Yals * yals) {
+  return COUNT (yals->cdb) > yals->addedcdb ||
+         COUNT (yals->xcdb) > yals->addedxcdb ||
+         !EMPTY (yals->trail) ||
+         yals->addednvars > yals->nvars;
+}
+
+// Returns 1 or -1 if 'lit' is fixed to true or false by a unit.
+
+static int yals_fixed (Yals * yals, int lit) {
+  int idx = ABS (lit), res;
+  if (GETBIT (yals->set, yals->nvarwords, idx)) res = 1;
+  else if (!GETBIT (yals->clear, yals->nvarwords, idx)) res = -1;
+  else return 0;
+  return lit < 0 ? -res : res;
+}
+
+static int yals_occurs (Yals * yals, int idx) {
+  return yals->occs[*yals_refs (yals, idx)] >= 0 ||
+         yals->occs[*yals_refs (yals, -idx)] >= 0 ||
+         yals->occs[*yals_xrefs (yals, idx)] >= 0;
+}
+
+static void yals_extend_vars (Yals * yals) {
+  const int nvars = yals->nvars, newnvars = yals->addednvars;
+  const int nvarwords = yals->nvarwords;
+  const int newnvarwords = (newnvars + BITS_PER_WORD - 1) / BITS_PER_WORD;
+  int idx, i;
+  assert (nvars < newnvars);
+  RSZ (yals->refs, 3*nvars, 3*newnvars);
+  RSZ (yals->occs, yals->noccs, yals->noccs + 3*(newnvars - nvars));
+  for (i = 3*nvars; i < 3*newnvars; i++) {
+    yals->refs[i] = yals->noccs;
+    yals->occs[yals->noccs++] = -1;
+  }
+  if (yals->e2i) {
+    RSZ (yals->e2i, nvars, newnvars);
+    RSZ (yals->i2e, nvars, newnvars);
+    for (idx = nvars; idx < newnvars; idx++)
+      yals->e2i[idx] = yals->i2e[idx] = idx;
+  }
+  if (newnvarwords > nvarwords) {
+    yals_reset_cache (yals);
+    RSZ (yals->set, nvarwords, newnvarwords);
+    RSZ (yals->clear, nvarwords, newnvarwords);
+    memset (yals->clear + nvarwords, 0xff,
+      (newnvarwords - nvarwords) * sizeof (Word));
+    if (yals->best) RSZ (yals->best, nvarwords, newnvarwords);
+    if (yals->vals) {
+      RSZ (yals->vals, nvarwords, newnvarwords);
+      RSZ (yals->tmp, nvarwords, newnvarwords);
+      RSZ (yals->old, nvarwords, newnvarwords);
+    }
+    yals->nvarwords = newnvarwords;
+  }
+  if (yals->vals) {
+    RSZ (yals->flips, nvars, newnvars);
+    if (yals->weightedbreak)
+      RSZ (yals->weightedbreak, 2*nvars, 2*newnvars);
+    if (yals->xweightedbreak)
+      RSZ (yals->xweightedbreak, nvars, newnvars);
+  }
+  yals->nvars = newnvars;
+  yals_msg (yals, 1, "added %d variables", newnvars - nvars);
+}
+
+static void yals_compact_occs (Yals * yals) {
+  const int size = yals->noccs - yals->garbageoccs;
+  int * occs, i, n, start;
+  NEWN (occs, size);
+  for (n = 0, i = 3; i < 3*yals->nvars; i++) {
+    start = yals->refs[i];
+    yals->refs[i] = n;
+    while ((occs[n++] = yals->occs[start++]) >= 0)
+      ;
   }
+  assert (n == size);
+  DELN (yals->occs, yals->noccs);
+  yals->occs = occs;
+  yals->noccs = size;
+  yals->garbageoccs = 0;
+  yals_msg (yals, 2, "compacted occurrences to %d", size);
+}
 
+// Adds the occurrences of OR clauses starting at 'cidx' and XOR clauses
+// starting at 'xcidx'.  While counting them the reference of a touched
+// occurrence list is temporarily replaced by minus one minus its position
+// on 'touched'.  Abandoned lists are reclaimed if they make up half of
+// 'occs'.
+
+static void yals_extend_occs (Yals * yals, int cidx, int xcidx) {
+  STACK(int) pairs, touched, starts, counts;
+  int i, len, lit, size, occs, start, n, * ref;
+  const int * p;
+  INIT (pairs); INIT (touched); INIT (starts); INIT (counts);
+  for (; cidx < yals->nclauses; cidx++) {
+    p = yals_lits_nomems (yals, cidx);
+    for (len = 0; len < MAXLEN && p[len]; len++)
+      ;
+    for (; (lit = *p); p++) {
+      PUSH (pairs, yals_refs (yals, lit) - yals->refs);
+      PUSH (pairs, yals->wideoccs ? cidx : (cidx << LENSHIFT) | len);
+    }
+  }
+  for (; xcidx < yals->nxclauses; xcidx++) {
+    p = yals->xcdb.start + yals->xlits[xcidx];
+    for (len = 0; len < MAXLEN && p[len]; len++)
+      ;
+    for (; (lit = *p); p++) {
+      PUSH (pairs, yals_xrefs (yals, lit) - yals->refs);
+      PUSH (pairs, yals->wideoccs ? xcidx : (xcidx << LENSHIFT) | len);
+    }
+  }
+  for (i = 0; i < COUNT (pairs); i += 2) {
+    ref = yals->refs + PEEK (pairs, i);
+    if (*ref >= 0) {
+      PUSH (touched, ref - yals->refs);
+      PUSH (starts, *ref);
+      PUSH (counts, 0);
+      *ref = -(int) COUNT (touched);
+    }
+    counts.start[-1 - *ref]++;
+  }
+  size = 0;
+  for (i = 0; i < COUNT (touched); i++) {
+    for (n = start = PEEK (starts, i); yals->occs[n] >= 0; n++)
+      ;
+    yals->garbageoccs += n - start + 1;
+    size += n - start + PEEK (counts, i) + 1;
+  }
+  RSZ (yals->occs, yals->noccs, yals->noccs + size);
+  occs = yals->noccs;
+  for (i = 0; i < COUNT (touched); i++) {
+    start = PEEK (starts, i);
+    POKE (starts, i, occs);
+    while (yals->occs[start] >= 0)
+      yals->occs[occs++] = yals->occs[start++];
+    n = PEEK (counts, i);
+    POKE (counts, i, occs);
+    occs += n;
+    yals->occs[occs++] = -1;
+  }
+  yals->noccs += size;
+  assert (occs == yals->noccs);
+  for (i = 0; i < COUNT (pairs); i += 2) {
+    ref = yals->refs + PEEK (pairs, i);
+    yals->occs[counts.start[-1 - *ref]++] = PEEK (pairs, i + 1);
+  }
+  for (i = 0; i < COUNT (touched); i++)
+    yals->refs[PEEK (touched, i)] = PEEK (starts, i);
+  yals_msg (yals, 2,
+    "moved %d occurrence lists for %d new occurrences",
+    (int) COUNT (touched), (int) COUNT (pairs) / 2);
+  RELEASE (counts);
+  RELEASE (starts);
+  RELEASE (touched);
+  RELEASE (pairs);
+  if (2*yals->garbageoccs > yals->noccs) yals_compact_occs (yals);
+}
+
+// Connects the simplified added clauses after the connected ones.
+
+static void yals_connect_added (Yals * yals) {
+  const int nclauses = yals->nclauses, nxclauses = yals->nxclauses;
+  const int nlits = yals_nlits (yals);
+  int cidx, len, nor, nxor, i;
+  const int * p, * q;
+  double sumlen;
+
+  nor = 0;
+  for (p = yals->cdb.start + yals->addedcdb; p < yals->cdb.top; p++)
+    if (!*p) nor++;
+  nxor = yals->nxparities - nxclauses;
+
+  if (yals->xmasks) {
+    DELN (yals->xmasks, yals->nxmasks);
+    DELN (yals->xmaskrefs, nxclauses + 1);
+    yals->xmasks = 0, yals->xmaskrefs = 0;
+  }
+
+  RSZ (yals->lits, nlits, nlits + nor);
+  if (yals->wideoccs) RSZ (yals->lens, nclauses, nclauses + nor);
+  sumlen = yals->avglen * nclauses;
+  cidx = nclauses, i = nlits;
+  for (p = yals->cdb.start + yals->addedcdb; p < yals->cdb.top; p = q + 1) {
+    for (q = p; *q; q++)
+      ;
+    len = q - p;
+    yals->lits[i++] = p - yals->cdb.start;
+    if (yals->wideoccs) yals->lens[cidx] = MIN (len, MAXLEN);
+    if (len > yals->maxlen) yals->maxlen = len;
+    if (len < yals->minlen) yals->minlen = len;
+    sumlen += len;
+    cidx++;
+  }
+  if (yals->vals && !yals_keep_search (yals)) yals_disconnect (yals);
+  if (yals->vals && nor) yals_queue_xclauses (yals, nxclauses, 0);
+  yals->nclauses += nor;
+  yals->avglen = yals_avg (sumlen, yals->nclauses);
+
+  RSZ (yals->xlits, nxclauses, nxclauses + nxor);
+  cidx = nxclauses;
+  for (p = yals->xcdb.start + yals->addedxcdb; p < yals->xcdb.top; p = q + 1) {
+    for (q = p; *q; q++)
+      ;
+    yals->xlits[cidx++] = p - yals->xcdb.start;
+  }
+  yals->nxclauses += nxor;
+
+  yals_extend_occs (yals, nclauses, nxclauses);
+  if (yals->opts.xmasks.val && yals->nxclauses) yals_init_xmasks (yals);
+  if (yals->vals) yals_extend_search (yals, nclauses, nxclauses);
+
+  yals_msg (yals, 1,
+    "connected %d added OR clauses and %d added XOR clauses",
+    nor, nxor);
+}
+
+// Propagates all units over the whole formula and connects it again.
+
+static void yals_reconnect_formula (Yals * yals) {
+  int idx, val;
+  for (idx = 1; idx < yals->nvars; idx++)
+    if ((val = yals_fixed (yals, idx)))
+      PUSH (yals->trail, val * idx);
+  yals_disconnect (yals);
+  yals_disconnect_formula (yals);
+  yals_msg (yals, 1, "connecting whole formula again");
+  if (yals->opts.prep.val) {
+    yals_preprocess (yals);
+    if (yals->mt) {
+      yals_msg (yals, 1,
+        "extended formula after unit propagation contains empty clause");
+      return;
+    }
+  }
+  yals_connect_formula (yals);
+}
+
+static void yals_extend_formula (Yals * yals) {
+  const int nxclauses = yals->nxclauses;
+  int * c, * p, * q, * start, lit, val, len, cidx, xcidx, sat, nunits;
+  unsigned parity;
+  uint64_t res;
+
+  res = yals->fingerprint;
+  for (p = yals->cdb.start + yals->addedcdb; p < yals->cdb.top; p++)
+    res = (res + (unsigned) *p) * 1099511628211ull;
+  for (p = yals->xcdb.start + yals->addedxcdb; p < yals->xcdb.top; p++)
+    res = (res + (unsigned) *p + 1) * 1099511628211ull;
+  for (cidx = nxclauses; cidx < yals->nxparities; cidx++)
+    res = (res + yals_xparity (yals, cidx)) * 1099511628211ull;
+  for (p = yals->trail.start; p < yals->trail.top; p++)
+    res = (res + (unsigned) *p) * 1099511628211ull;
+  yals->fingerprint = res;
+
+  if (yals->addednvars > yals->nvars) yals_extend_vars (yals);
+  for (p = yals->trail.start; p < yals->trail.top; p++)
+    *p = yals_import_lit (yals, *p);
+
+  q = yals->cdb.start + yals->addedcdb;
+  for (c = q; c < yals->cdb.top; c = p + 1) {
+    start = q, sat = 0;
+    for (p = c; (lit = *p); p++) {
+      lit = yals_import_lit (yals, lit);
+      if ((val = yals_fixed (yals, lit)) > 0) sat = 1;
+      else if (!val) *q++ = lit;
+    }
+    len = q - start;
+    if (sat) q = start;
+    else if (len > 1) *q++ = 0;
+    else if (len) { PUSH (yals->trail, *start); q = start; }
+    else yals->mt = 1;
+  }
+  yals->cdb.top = q;
+
+  q = yals->xcdb.start + yals->addedxcdb;
+  for (c = q, cidx = xcidx = nxclauses; c < yals->xcdb.top; c = p + 1) {
+    start = q, parity = yals_xparity (yals, cidx++);
+    for (p = c; (lit = *p); p++) {
+      lit = yals_import_lit (yals, lit);
+      if ((val = yals_fixed (yals, lit))) parity ^= (val > 0);
+      else *q++ = lit;
+    }
+    len = q - start;
+    if (len > 1) *q++ = 0, yals_setxparity (yals, xcidx++, parity);
+    else if (len) {
+      PUSH (yals->trail, parity ? -*start : *start);
+      q = start;
+    }
+    else if (!parity) yals->mt = 1;
+  }
+  yals->xcdb.top = q;
+  yals->nxparities = xcidx;
+  yals->xparitydb.top =
+    yals->xparitydb.start + (xcidx + BITS_PER_WORD - 1) / BITS_PER_WORD;
+  if (xcidx & BITMAPMASK)
+    yals->xparitydb.top[-1] &= BIT (xcidx) - 1;
+
+  if (yals->mt) {
+    yals_msg (yals, 1, "added clauses are inconsistent with units");
+    return;
+  }
+
+  if (!yals->wideoccs &&
+      ((INT_MAX >> LENSHIFT) <
+         yals->nclauses + COUNT (yals->cdb) - yals->addedcdb ||
+       (INT_MAX >> LENSHIFT) < xcidx))
+    goto RECONNECT;
+
+  yals_connect_added (yals);
+
+  nunits = 0;
+  for (p = yals->trail.start; p < yals->trail.top; p++) {
+    lit = *p;
+    if ((val = yals_fixed (yals, lit)) > 0) continue;
+    if (val < 0) {
+      yals_msg (yals, 1, "added unit %d inconsistent",
+        yals_export_lit (yals, lit));
+      yals->mt = 1;
+      return;
+    }
+    if (yals_occurs (yals, ABS (lit))) goto RECONNECT;
+    if (lit < 0) CLRBIT (yals->clear, yals->nvarwords, -lit);
+    else SETBIT (yals->set, yals->nvarwords, lit);
+    nunits++;
+  }
+  RELEASE (yals->trail);
+  RELEASE (yals->mark);
+  if (nunits) yals_msg (yals, 1, "fixed %d added units", nunits);
+  goto DONE;
+
+RECONNECT:
+  yals_reconnect_formula (yals);
+DONE:
+  yals->addedcdb = COUNT (yals->cdb);
+  yals->addedxcdb = COUNT (yals->xcdb);
+  yals->addednvars = yals->nvars;
+}
+
+int yals_prepare (Yals * yals) {
   if (!EMPTY (yals->clause))
-    yals_abort (yals, "added clause incomplete in 'yals_sat'");
+    yals_abort (yals, "added clause incomplete in 'yals_prepare'");
+
+  if (yals->prepared) {
+    if (!yals->mt && !yals->master && yals_added (yals))
+      yals_extend_formula (yals);
+    return yals->mt ? 20 : 0;
+  }
+
+  yals->prepared = 1;
+  yals->fingerprint = yals_fingerprint (yals);
 
   if (yals->mt) {
     yals_msg (yals, 1, "original formula contains empty clause");
@@ -3600,10 +5641,229 @@ int yals_sat (Yals * yals) {
     }
   }
 
+  if (yals->opts.reorder.val) yals_reorder (yals);
+  yals_connect_formula (yals);
+  yals->addedcdb = COUNT (yals->cdb);
+  yals->addedxcdb = COUNT (yals->xcdb);
+  yals->addednvars = yals->nvars;
+
+  return 0;
+}
+
+static void yals_init_elites (Yals * yals) {
+  Elite * e;
+  yals->nelites = yals->opts.elite.val;
+  NEWN (yals->elites, yals->nelites);
+  for (e = yals->elites; e < yals->elites + yals->nelites; e++) {
+    e->min = INT_MAX;
+    NEWN (e->vals, yals->nvarwords);
+  }
+  yals_msg (yals, 1,
+    "elite pool of %d assignments shared with attached instances",
+    yals->nelites);
+}
+
+void yals_attach (Yals * yals, Yals * master) {
+  int * p;
+
+  if (master->master) master = master->master;
+  if (master == yals)
+    yals_abort (yals, "can not attach instance to itself");
+  if (!master->prepared)
+    yals_abort (yals, "formula to attach to not prepared in 'yals_attach'");
+  if (yals->prepared || yals->nvars ||
+      !EMPTY (yals->clause) || !EMPTY (yals->trail))
+    yals_abort (yals, "literals added before 'yals_attach'");
+
+  if (!master->elites && master->opts.elite.val && !master->mt)
+    yals_init_elites (master);
+
+  yals->master = master;
+  master->attached++;
+  yals->prepared = 1;
+  yals->mt = master->mt;
+  yals->nvars = master->nvars;
+  yals->refs = master->refs;
+  yals->e2i = master->e2i;
+  yals->i2e = master->i2e;
+  yals->cdb = master->cdb;
+  yals->xcdb = master->xcdb;
+  yals->xparitydb = master->xparitydb;
+  yals->nxparities = master->nxparities;
+  yals->occs = master->occs;
+  yals->noccs = master->noccs;
+  yals->wideoccs = master->wideoccs;
+  yals->lens = master->lens;
+  yals->lits = master->lits;
+  yals->inlinesmall = master->inlinesmall;
+  yals->xlits = master->xlits;
+  yals->xmasks = master->xmasks;
+  yals->xmaskrefs = master->xmaskrefs;
+  yals->nxmasks = master->nxmasks;
+  yals->nclauses = master->nclauses;
+  yals->nxclauses = master->nxclauses;
+  yals->nbin = master->nbin;
+  yals->ntrn = master->ntrn;
+  yals->minlen = master->minlen;
+  yals->maxlen = master->maxlen;
+  yals->avglen = master->avglen;
+  yals->nvarwords = master->nvarwords;
+  yals->set = master->set;
+  yals->clear = master->clear;
+  yals->elites = master->elites;
+  yals->nelites = master->nelites;
+  yals->fingerprint = master->fingerprint;
+
+  for (p = yals->phases.start; p < yals->phases.top; p++)
+    *p = yals_import_lit (yals, *p);
+
+  yals_msg (yals, 1,
+    "attached to %d OR and %d XOR clauses over %d variables",
+    yals->nclauses, yals->nxclauses, yals->nvars - 1);
+}
+
+void yals_inherit_tables (Yals * yals, Yals * from) {
+  size_t bytes;
+  if (from == yals)
+    yals_abort (yals, "can not inherit tables from itself");
+  if (from->mem.mgr != yals->mem.mgr ||
+      from->mem.malloc != yals->mem.malloc ||
+      from->mem.realloc != yals->mem.realloc ||
+      from->mem.free != yals->mem.free)
+    yals_abort (yals, "different memory managers in 'yals_inherit_tables'");
+  if (!EMPTY (yals->exp.table.cb))
+    yals_abort (yals, "tables already computed in 'yals_inherit_tables'");
+  RELEASE (yals->exp.table.two);
+  RELEASE (yals->exp.table.fixed);
+  bytes = SIZE (from->exp.table.two) + SIZE (from->exp.table.cb);
+  bytes += SIZE (from->exp.table.fixed);
+  bytes *= sizeof (double);
+  yals->exp = from->exp;
+  memset (&from->exp, 0, sizeof from->exp);
+  yals_dec_allocated (from, bytes);
+  yals_inc_allocated (yals, bytes);
+  yals_msg (yals, 1,
+    "inherited score tables of %.1f MB", bytes / (double)(1<<20));
+}
+
+/*------------------------------------------------------------------------*/
+
+// Assumptions are fixed like units through copies of 'set' and 'clear',
+// which 'yals_set_units' applies after every pick of an assignment, and
+// are never flipped, without touching the connected formula.  Then a
+// falsified clause has to contain a literal which is not assumed, since
+// otherwise the assumptions fail and the search is skipped.  Units do not
+// occur in clauses after 'yals_preprocess', thus only clauses with
+// assumed variables are checked.
+
+static int yals_falsified_by_assumptions (Yals * yals, int cidx) {
+  const int * p;
+  unsigned parity;
+  int lit, val;
+  if (cidx < yals->nclauses) {
+    for (p = yals_lits_nomems (yals, cidx); (lit = *p); p++)
+      if (yals_fixed (yals, lit) >= 0) return 0;
+    return 1;
+  }
+  cidx -= yals->nclauses;
+  parity = yals_xparity (yals, cidx);
+  for (p = yals->xcdb.start + yals->xlits[cidx]; (lit = *p); p++) {
+    if (!(val = yals_fixed (yals, lit))) return 0;
+    parity ^= (val > 0);
+  }
+  return !parity;
+}
+
+static int yals_failed_assumption (Yals * yals, int lit) {
+  const int * p;
+  int occ, i;
+  for (i = 0; i < 3; i++) {
+    if (i < 2) p = yals->occs + *yals_refs (yals, i ? -lit : lit);
+    else p = yals->occs + *yals_xrefs (yals, ABS (lit));
+    for (; (occ = *p) >= 0; p++)
+      if (yals_falsified_by_assumptions (yals,
+            (i < 2 ? 0 : yals->nclauses) +
+            yals_occ_cidx (occ, yals->wideoccs)))
+        return 1;
+  }
+  return 0;
+}
+
+static void yals_reset_assumptions (Yals * yals) {
+  RELEASE (yals->assumptions);
+  if (!yals->frozen) return;
+  DELN (yals->frozen, yals->nvarwords);
+  DELN (yals->set, yals->nvarwords);
+  DELN (yals->clear, yals->nvarwords);
+  yals->set = yals->unitset, yals->clear = yals->unitclear;
+  yals->frozen = yals->unitset = yals->unitclear = 0;
+}
+
+static int yals_apply_assumptions (Yals * yals) {
+  const size_t bytes = yals->nvarwords * sizeof (Word);
+  int i, lit, idx, val, nfrozen;
+  yals->unitset = yals->set, yals->unitclear = yals->clear;
+  NEWN (yals->set, yals->nvarwords);
+  NEWN (yals->clear, yals->nvarwords);
+  NEWN (yals->frozen, yals->nvarwords);
+  memcpy (yals->set, yals->unitset, bytes);
+  memcpy (yals->clear, yals->unitclear, bytes);
+  nfrozen = 0;
+  for (i = 0; i < COUNT (yals->assumptions); i++) {
+    lit = yals_import_lit (yals, PEEK (yals->assumptions, i));
+    idx = ABS (lit);
+    assert (idx < yals->nvars);
+    if ((val = yals_fixed (yals, lit)) > 0) continue;
+    if (val < 0) {
+      yals_msg (yals, 1, "assumption %d inconsistent",
+        PEEK (yals->assumptions, i));
+      return 20;
+    }
+    if (lit < 0) CLRBIT (yals->clear, yals->nvarwords, idx);
+    else SETBIT (yals->set, yals->nvarwords, idx);
+    SETBIT (yals->frozen, yals->nvarwords, idx);
+    POKE (yals->assumptions, nfrozen, lit);
+    nfrozen++;
+  }
+  yals->assumptions.top = yals->assumptions.start + nfrozen;
+  for (i = 0; i < nfrozen; i++)
+    if (yals_failed_assumption (yals, PEEK (yals->assumptions, i))) {
+      yals_msg (yals, 1, "assumptions falsify a clause");
+      return 20;
+    }
+  yals_msg (yals, 1, "assuming %d literals", nfrozen);
+  return 0;
+}
+
+int yals_sat (Yals * yals) {
+  int res, limited = 0, lkhd, connected;
+
+  if (yals->best) {
+    if (yals->cacheloaded) yals->warm = 0;
+    else {
+      yals_reset_cache (yals);
+      yals->warm = yals->opts.warm.val && yals->stats.best < INT_MAX;
+    }
+    yals->stats.best = yals->stats.tmp = yals->stats.last = INT_MAX;
+    yals->limits.report.min = INT_MAX;
+  }
+
+  if (!(res = yals_prepare (yals)) && !EMPTY (yals->assumptions))
+    res = yals_apply_assumptions (yals);
+  if (res) {
+    yals_reset_assumptions (yals);
+    return res;
+  }
+
+  if (yals->opts.maxorigvar.val != 0) {
+    assert(yals->opts.maxorigvar.val < yals->nvars);
+  }
+
   yals->stats.time.entered = yals_time (yals);
 
-  if (yals->opts.setfpu.val) yals_set_fpu (yals);
-  yals_connect (yals);
+  if (yals->opts.setfpu.val && !yals->opts.intweights.val)
+    yals_set_fpu (yals);
+  if (!(connected = (yals->vals != 0))) yals_connect (yals);
 
   res = 0;
   limited += (yals->limits.flips >= 0);
@@ -3633,7 +5893,7 @@ int yals_sat (Yals * yals) {
 #endif
   }
 
-  yals_outer_loop (yals);
+  yals_outer_loop (yals, connected);
 
   assert (!yals->mt);
   if (!yals->stats.best) {
@@ -3645,10 +5905,12 @@ int yals_sat (Yals * yals) {
   if ((lkhd = yals_lkhd_internal (yals)))
     yals_msg (yals, 1,
       "most flipped literal %d flipped %lld times",
-      lkhd, (long long) yals->flips[ABS (lkhd)]);
+      yals_export_lit (yals, lkhd), (long long) yals->flips[ABS (lkhd)]);
 
-  if (yals->opts.setfpu.val) yals_reset_fpu (yals);
+  if (yals->opts.setfpu.val && !yals->opts.intweights.val)
+    yals_reset_fpu (yals);
   yals_flush_time (yals);
+  yals_reset_assumptions (yals);
 
   return res;
 }
@@ -3657,8 +5919,9 @@ int yals_sat (Yals * yals) {
 
 int yals_deref (Yals * yals, int lit) {
   if (!lit) yals_abort (yals, "zero literal argument to 'yals_val'");
-  if (yals->mt || ABS (lit) >= yals->nvars) return lit < 0 ? 1 : -1;
-  return yals_best (yals, lit) ? 1 : -1;
+  if (yals->mt || !yals->best || ABS (lit) >= yals->nvars)
+    return lit < 0 ? 1 : -1;
+  return yals_best (yals, yals_import_lit (yals, lit)) ? 1 : -1;
 }
 
 int yals_minimum (Yals * yals) { return yals->stats.best; }
@@ -3675,11 +5938,12 @@ long long yals_mems (Yals * yals) {
 
 int yals_lkhd (Yals * yals) {
   int res = yals_lkhd_internal (yals);
-  if (res)
+  if (res) {
     yals_msg (yals, 1,
       "look ahead literal %d flipped %lld times",
-      res, (long long) yals->flips [ABS (res)]);
-  else
+      yals_export_lit (yals, res), (long long) yals->flips [ABS (res)]);
+    res = yals_export_lit (yals, res);
+  } else
     yals_msg (yals, 2, "no look ahead literal found");
   return res;
 }
@@ -3699,7 +5963,7 @@ static void yals_minlits_cidx (Yals * yals, int cidx) {
     assert (idx < yals->nvars);
     if (yals->mark.start[idx]) continue;
     yals->mark.start[idx] = 1;
-    PUSH (yals->minlits, lit);
+    PUSH (yals->minlits, yals_export_lit (yals, lit));
   }
 }
 
@@ -3728,6 +5992,7 @@ void yals_stats (Yals * yals) {
   Stats * s = &yals->stats;
   double t = s->time.total;
   int64_t sum;
+  int i;
   yals_msg (yals, 0,
     "restart time %.3f seconds %.0f%%",
     s->time.restart, yals_pct (s->time.restart, s->time.total));
@@ -3735,6 +6000,11 @@ void yals_stats (Yals * yals) {
     "%lld inner restarts, %lld maximum interval",
     (long long) s->restart.inner.count,
     (long long) s->restart.inner.maxint);
+  yals_msg (yals, 0,
+    "%lld incremental restarts %.0f%%, %.1f flipped variables on average",
+    (long long) s->restart.inner.incremental,
+    yals_pct (s->restart.inner.incremental, s->restart.inner.count),
+    yals_avg (s->restart.inner.diffs, s->restart.inner.incremental));
   yals_msg (yals, 0,
     "%lld outer restarts, %lld maximum interval",
     (long long) s->restart.outer.count,
@@ -3745,16 +6015,34 @@ void yals_stats (Yals * yals) {
     (long long) s->strat.def, yals_pct (s->strat.def, sum),
     (long long) s->strat.rnd, yals_pct (s->strat.rnd, sum));
   yals_msg (yals, 0,
-    "picked best=%lld cached=%lld keep=%lld pos=%lld neg=%lld rnd=%lld",
+    "picked best=%lld cached=%lld elite=%lld keep=%lld pos=%lld neg=%lld rnd=%lld",
     (long long) s->pick.best, (long long) s->pick.cached,
+    (long long) s->pick.elite,
     (long long) s->pick.keep, (long long) s->pick.pos,
     (long long) s->pick.neg, (long long) s->pick.rnd);
+  if (yals->elites)
+    yals_msg (yals, 0,
+      "published %lld elite assignments, %lld busy, %lld torn reads",
+      (long long) s->elite.published,
+      (long long) s->elite.busy, (long long) s->elite.torn);
   sum = s->cache.inserted + s->cache.replaced;
   yals_msg (yals, 0,
     "cached %lld assignments, %lld replaced %.0f%%, %lld skipped, %d size",
     (long long) sum,
     (long long) s->cache.replaced, yals_pct (s->cache.replaced, sum),
     (long long) s->cache.skipped, (int) COUNT (yals->cache));
+  if (!EMPTY (yals->cache)) {
+    double bytes = 0, raw;
+    for (i = 0; i < COUNT (yals->cache); i++)
+      bytes += PEEK (yals->cachesizes, i);
+    raw = COUNT (yals->cache) * (double) yals->nvarwords * sizeof (Word);
+    yals_msg (yals, 0,
+      "cached assignments use %.1f MB, %.0f%% of uncompressed %.1f MB",
+      bytes / (double)(1<<20), yals_pct (bytes, raw), raw / (double)(1<<20));
+  }
+  if (s->cache.loaded)
+    yals_msg (yals, 0,
+      "loaded %lld cached assignments", (long long) s->cache.loaded);
   sum = s->sig.falsepos + s->sig.truepos;
   yals_msg (yals, 0,
     "%lld sigchecks, %lld negative %.0f%%, "
@@ -3763,7 +6051,19 @@ void yals_stats (Yals * yals) {
     (long long) s->sig.neg, yals_pct (s->sig.neg, s->sig.search),
     (long long) sum, yals_pct (sum, s->sig.search),
     (long long) s->sig.falsepos, yals_pct (s->sig.falsepos, s->sig.search));
-  if (yals->unsat.usequeue) {
+  if (yals->unsat.usedeque) {
+    yals_msg (yals, 0,
+      "maximum unsat deque size %d, %lld unfair",
+      s->maxstacksize, (long long) s->queue.unfair);
+    yals_msg (yals, 0,
+      "%lld compactions in %.3f seconds %.0f%%",
+      (long long) s->defrag.count,
+      s->time.defrag, yals_pct (s->time.defrag, s->time.total));
+    yals_msg (yals, 0,
+      "moved %lld in total and %.1f on average per compaction",
+      (long long) s->defrag.moved,
+      yals_avg (s->defrag.moved, s->defrag.count));
+  } else if (yals->unsat.usequeue) {
     yals_msg (yals, 0,
       "allocated max %d chunks %d links %lld unfair",
       s->queue.max.chunks, s->queue.max.lnks, (long long) s->queue.unfair);
@@ -3879,10 +6179,10 @@ void yals_stats (Yals * yals) {
 
     int idx;
     for (idx = 1; idx <= yals->opts.maxorigvar.val && idx < yals->nvars; idx++) {
-      origFlips += yals->flips[idx];
+      origFlips += yals->flips[yals_import_lit (yals, idx)];
     }
     for (idx = yals->opts.maxorigvar.val + 1; idx < yals->nvars; idx++) {
-      auxFlips += yals->flips[idx];
+      auxFlips += yals->flips[yals_import_lit (yals, idx)];
     }
 
     yals_msg (yals, 0,
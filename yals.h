@@ -47,8 +47,54 @@ void yals_begin_xor_clause(Yals *);
 
 void yals_add (Yals *, int lit);
 
+void yals_add_clauses (Yals *,
+       const int * lits, size_t n, const unsigned char * xors);
+
+// Clauses, units and new variables can also be added after 'yals_sat'
+// returned.  The next call then only connects what was added, keeps the
+// search state unless options changed, and by default ('--warm') starts
+// from the best assignment of the previous call.
+// Limits on flips and mems apply to the totals over all calls.
+
 int yals_sat (Yals *);
 
+// Assumed literals are fixed and never flipped during the next 'yals_sat'
+// call only, which returns 20 if they contradict units or falsify a clause
+// on their own.  The formula stays connected and is not simplified.
+// Variables not yet in the formula are added.
+
+void yals_assume (Yals *, int lit);
+
+/*------------------------------------------------------------------------*/
+
+// Connecting the formula is otherwise done in 'yals_sat'.  Afterwards
+// other fresh instances can share it read-only through 'yals_attach'
+// instead of adding the same clauses again.  The prepared instance then
+// has to be deleted last.  Returns 20 if the formula is found to be
+// unsatisfiable and zero otherwise.
+
+int yals_prepare (Yals *);
+void yals_attach (Yals *, Yals * prepared);
+
+/*------------------------------------------------------------------------*/
+
+// Cached restart assignments (and the best one) can be persisted after
+// 'yals_sat' and read back into a prepared or attached instance of the
+// same formula to resume the search from there.  Both return the number
+// of assignments written or actually added to the cache.
+
+int yals_write_cache (Yals *, FILE *);
+int yals_read_cache (Yals *, FILE *);
+
+/*------------------------------------------------------------------------*/
+
+// Moves the score tables computed by 'yals_sat' from an instance which is
+// not used anymore to a fresh one with the same memory manager.  They are
+// reused if the new instance runs with the same '--cb' value, which saves
+// recomputing them when solving many small formulas one after the other.
+
+void yals_inherit_tables (Yals *, Yals * from);
+
 /*------------------------------------------------------------------------*/
 
 long long yals_flips (Yals *);